@@ -1,50 +1,141 @@
 #pragma once
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <ostream>
+#include <cstdint>
+#include <type_traits>
+#include "AstArena.hpp"
+#include "Interner.hpp"
+#include "Operator.hpp"
 #include "Token.hpp"
 #include <vector>
 
 // ö
-enum class Type { INT, CHAR, VOID, DOUBLE };
+// ERROR ֻʾѱıʽ
+enum class Type : unsigned char { INT, CHAR, VOID, DOUBLE, ERROR };
 
-inline std::string typeToString(Type t) {
+// ڴ棬Ƶĵطʹ
+inline const char* typeSpelling(Type t) {
     switch(t) {
         case Type::INT: return "int";
         case Type::CHAR: return "char";
         case Type::VOID: return "void";
 		case Type::DOUBLE: return "double";
+		case Type::ERROR: return "<error>";
 		default: return "unknown";
     }
 }
 
+inline std::string typeToString(Type t) {
+	return typeSpelling(t);
+}
+
+
 
+// Concrete node kind, so passes can dispatch with a switch instead of dynamic_cast chains
+enum class NodeKind : unsigned char {
+	Program,
+	VarDecl, FunDecl, Param,
+	CompoundStmt, IfStmt, WhileStmt, ForStmt, ReturnStmt, ExprStmt,
+	IntLiteral, CharLiteral, DoubleLiteral, ValExpr, AssignExpr, BinaryExpr, UnaryExpr, CallExpr,
+};
+
+// ķűţȫֱڰ˳ţ
+// βκ;ֲڴ0ŲkLocalSymbol־
+using SymbolId=uint32_t;
+constexpr SymbolId kNoSymbol=0xFFFFFFFFu;
+constexpr SymbolId kLocalSymbol=0x80000000u;
+inline bool isLocalSymbol(SymbolId id){ return id!=kNoSymbol&&(id&kLocalSymbol)!=0; }
+// ȫֱţڵľֲ
+inline uint32_t symbolIndex(SymbolId id){ return id&~kLocalSymbol; }
 
 // ASTڵ
 struct ASTNode{
-	int line=0,col=0;
+	const NodeKind kind;
+	// Դ[begin,end)ֽƫƣҪʱLineMap㣻endΪ0ʾûλ
+	uint32_t begin=0,end=0;
+	explicit ASTNode(NodeKind k):kind(k){}
 	virtual ~ASTNode()=default;
 	virtual void dump(std::ostream &out, int indent=0) const = 0;
 };
 
-using ASTNodePtr = std::unique_ptr<ASTNode>;
+// Owning pointer to an AST node. Nodes built in an AstArena only have their
+// destructor run on release; their memory goes away with the arena.
+struct NodeDeleter{
+	bool inArena=false;
+	void operator()(ASTNode *p)const{
+		if(!p)return;
+		if(inArena)p->~ASTNode();
+		else delete p;
+	}
+};
+
+template<class T>
+using NodePtr = std::unique_ptr<T,NodeDeleter>;
+
+// Child list; allocates from the owning Program's arena.
+template<class T>
+using NodeList = std::pmr::vector<NodePtr<T>>;
+
+// Allocates a node in the arena (nodes with child lists get the arena as their allocator).
+template<class T>
+NodePtr<T> makeNode(AstArena &arena){
+	void *mem=arena.allocate(sizeof(T),alignof(T));
+	T *node;
+	if constexpr(std::is_constructible_v<T,std::pmr::memory_resource*>) node=new(mem)T(&arena);
+	else node=new(mem)T();
+	return NodePtr<T>(node,NodeDeleter{true});
+}
+
+// Heap-allocated node, for trees built outside a parse.
+template<class T>
+NodePtr<T> makeNode(){
+	return NodePtr<T>(new T(),NodeDeleter{false});
+}
+
+using ASTNodePtr = NodePtr<ASTNode>;
+
+// Kind checks for a single concrete type (replacement for one-off dynamic_casts)
+template<class T>
+bool isa(const ASTNode &n){ return n.kind==T::Kind; }
+
+template<class T>
+const T *dynCast(const ASTNode *n){
+	return n&&n->kind==T::Kind?static_cast<const T*>(n):nullptr;
+}
 
 // ʽ
-struct Expr : ASTNode{};
-using ExprPtr = std::unique_ptr<Expr>;
+// mutableԱдע⣬constʱҲд
+struct Expr : ASTNode{
+	mutable Type resolvedType=Type::ERROR;	// ʽͣǰʱΪERROR
+	explicit Expr(NodeKind k):ASTNode(k){}
+};
+using ExprPtr = NodePtr<Expr>;
 
 // 
-struct Stmt : ASTNode{};
-using StmtPtr = std::unique_ptr<Stmt>;
+struct Stmt : ASTNode{
+	explicit Stmt(NodeKind k):ASTNode(k){}
+};
+using StmtPtr = NodePtr<Stmt>;
 
 // 
-struct Decl : ASTNode{};
-using DeclPtr = std::unique_ptr<Decl>;
+struct Decl : ASTNode{
+	explicit Decl(NodeKind k):ASTNode(k){}
+};
+using DeclPtr = NodePtr<Decl>;
 
 
 
 // 
 struct Program : ASTNode{
-	std::vector<DeclPtr>decls;
+	// arena owning every node of this tree; declared first so it outlives decls
+	std::unique_ptr<AstArena>arena;
+	// arenas of subtrees spliced in from other parses (see ParallelParser)
+	std::vector<std::unique_ptr<AstArena>>adoptedArenas;
+	NodeList<Decl>decls;
+	static constexpr NodeKind Kind=NodeKind::Program;
+	Program():ASTNode(Kind),arena(std::make_unique<AstArena>()),decls(arena.get()){}
 	void dump(std::ostream &out, int indent) const override;
 };
 using ProgramPtr = std::unique_ptr<Program>;
@@ -58,14 +149,20 @@ std::string dumpAstToString(const Program &prog);
 struct VarDecl : Decl{
 	Type type;
 	std::string name;
+	NameId nameId=kNoName;	// ʶеı
+	mutable SymbolId symbol=kNoSymbol;	// ķű
 	ExprPtr init;	// nullable
+	static constexpr NodeKind Kind=NodeKind::VarDecl;
+	VarDecl():Decl(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // Ͻṹ
 struct CompoundStmt : Stmt{
-	std::vector<std::unique_ptr<VarDecl>>localVars;
-	std::vector<StmtPtr>stmts;
+	NodeList<VarDecl>localVars;
+	NodeList<Stmt>stmts;
+	static constexpr NodeKind Kind=NodeKind::CompoundStmt;
+	explicit CompoundStmt(std::pmr::memory_resource *mr=std::pmr::get_default_resource()):Stmt(Kind),localVars(mr),stmts(mr){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
@@ -73,6 +170,10 @@ struct CompoundStmt : Stmt{
 struct Param : ASTNode{
 	Type type;
 	std::string name;
+	NameId nameId=kNoName;	// ʶеı
+	mutable SymbolId symbol=kNoSymbol;	// ķű
+	static constexpr NodeKind Kind=NodeKind::Param;
+	Param():ASTNode(Kind){}
 	void dump(std::ostream &out, int indent) const override;
 };
 
@@ -81,8 +182,13 @@ struct Param : ASTNode{
 struct FunDecl : Decl{
 	Type returnType;
 	std::string name;
-	std::vector<std::unique_ptr<Param>>params;
-	std::unique_ptr<CompoundStmt>body;
+	NameId nameId=kNoName;	// ʶеı
+	mutable SymbolId symbol=kNoSymbol;	// ķű
+	mutable uint32_t localCount=0;		// βκ;ֲֲŵķΧ
+	NodeList<Param>params;
+	NodePtr<CompoundStmt>body;
+	static constexpr NodeKind Kind=NodeKind::FunDecl;
+	explicit FunDecl(std::pmr::memory_resource *mr=std::pmr::get_default_resource()):Decl(Kind),params(mr){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
@@ -90,6 +196,8 @@ struct FunDecl : Decl{
 struct IfStmt : Stmt{
 	ExprPtr cond;					// ʽ
 	StmtPtr thenBranch,elseBranch;	// thenṹ,elseṹ
+	static constexpr NodeKind Kind=NodeKind::IfStmt;
+	IfStmt():Stmt(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
@@ -97,6 +205,8 @@ struct IfStmt : Stmt{
 struct WhileStmt : Stmt{
 	ExprPtr cond;		// ʽ
 	StmtPtr body;		// ѭ
+	static constexpr NodeKind Kind=NodeKind::WhileStmt;
+	WhileStmt():Stmt(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
@@ -104,6 +214,8 @@ struct WhileStmt : Stmt{
 struct ForStmt : Stmt{
 	ExprPtr init,cond,update;	// nullable
 	StmtPtr body;				// ѭ
+	static constexpr NodeKind Kind=NodeKind::ForStmt;
+	ForStmt():Stmt(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
@@ -112,63 +224,87 @@ struct ForStmt : Stmt{
 // return
 struct ReturnStmt : Stmt{
 	ExprPtr expr;		// nullable
+	static constexpr NodeKind Kind=NodeKind::ReturnStmt;
+	ReturnStmt():Stmt(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // ʽ
 struct ExprStmt : Stmt{
 	ExprPtr expr;		// nullable
+	static constexpr NodeKind Kind=NodeKind::ExprStmt;
+	ExprStmt():Stmt(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // int
 struct IntLiteral : Expr{
 	std::string lexeme;
+	static constexpr NodeKind Kind=NodeKind::IntLiteral;
+	IntLiteral():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // char
 struct CharLiteral : Expr{
 	std::string lexeme;
+	static constexpr NodeKind Kind=NodeKind::CharLiteral;
+	CharLiteral():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // double
 struct DoubleLiteral : Expr{
 	std::string lexeme;
+	static constexpr NodeKind Kind=NodeKind::DoubleLiteral;
+	DoubleLiteral():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // 
 struct ValExpr : Expr{
 	std::string name;
+	NameId nameId=kNoName;	// ʶеı
+	mutable SymbolId symbol=kNoSymbol;	// õδʱΪkNoSymbol
+	static constexpr NodeKind Kind=NodeKind::ValExpr;
+	ValExpr():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // ֵ
 struct AssignExpr : Expr{
 	ExprPtr left,right;
+	static constexpr NodeKind Kind=NodeKind::AssignExpr;
+	AssignExpr():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // Ԫʽ
 struct BinaryExpr : Expr{
-	std::string op;
+	BinaryOp op=BinaryOp::Add;
 	ExprPtr left,right;
+	static constexpr NodeKind Kind=NodeKind::BinaryExpr;
+	BinaryExpr():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // һԪʽ
 struct UnaryExpr : Expr{
-	std::string op;
+	UnaryOp op=UnaryOp::Plus;
 	ExprPtr operand;
+	static constexpr NodeKind Kind=NodeKind::UnaryExpr;
+	UnaryExpr():Expr(Kind){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
 // ñʽ
 struct CallExpr : Expr{
 	std::string name;
-	std::vector<ExprPtr>args;
+	NameId nameId=kNoName;	// ʶеı
+	mutable SymbolId symbol=kNoSymbol;	// δʱΪkNoSymbol
+	NodeList<Expr>args;
+	static constexpr NodeKind Kind=NodeKind::CallExpr;
+	explicit CallExpr(std::pmr::memory_resource *mr=std::pmr::get_default_resource()):Expr(Kind),args(mr){}
 	void dump(std::ostream &out,int indent)const override;
 };
 
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <charconv>
 #include <iostream>
+#include <string>
+#include <thread>
 #include "CompileApp.hpp"
 
 
@@ -10,17 +14,44 @@ int main(int argc,char** argv){
 	}
 
 	std::string inPath, outPath;
+	unsigned threads=1;
+	std::string cacheDir;
 	for(int i=1;i<argc;i++){
 		std::string arg = argv[i];
 		if(arg=="-i" && i+1<argc){
 			inPath = argv[++i];
 		}else if(arg=="-o" && i+1<argc){
 			outPath = argv[++i];
+		}else if(arg=="-j" && i+1<argc){
+			// ﷨߳0 ʾʹȫӲ߳
+			std::string value = argv[++i];
+			unsigned n=0;
+			auto r = std::from_chars(value.data(), value.data()+value.size(), n);
+			if(r.ec!=std::errc() || r.ptr!=value.data()+value.size()){
+				std::cerr << "Unknown or incomplete argument: " << arg << " " << value << std::endl;
+				continue;
+			}
+			threads = n==0 ? std::max(1u, std::thread::hardware_concurrency()) : n;
+		}else if(arg=="-a" && i+1<argc){
+			// ASTtextsexpr  json
+			std::string format = argv[++i];
+			if(format=="text") compileApp.setAstFormat(AstFormat::Text);
+			else if(format=="sexpr") compileApp.setAstFormat(AstFormat::SExpr);
+			else if(format=="json") compileApp.setAstFormat(AstFormat::Json);
+			else std::cerr << "Unknown AST format: " << format << std::endl;
+		}else if(arg=="-c" && i+1<argc){
+			// ԴδʱøĿ¼»AST
+			cacheDir = argv[++i];
+		}else if(arg=="-O"){
+			// ǰַӱʽɾ
+			compileApp.setOptimize(true);
 		}else{
 			std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
 		}
 	}
 
+	compileApp.setThreads(threads);
+	compileApp.setCacheDir(cacheDir);
 	if(inPath.empty() && outPath.empty()){
 		compileApp.run();
 	}else{
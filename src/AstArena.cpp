@@ -0,0 +1,47 @@
+#include "AstArena.hpp"
+
+#include <cstdint>
+#include <new>
+
+AstArena::AstArena(size_t firstBlockSize) : nextBlockSize(firstBlockSize) {}
+
+AstArena::~AstArena() {
+	for (char* b : blocks) {
+		::operator delete(b);
+	}
+}
+
+void AstArena::grow(size_t minBytes) {
+	size_t size = nextBlockSize;
+	while (size < minBytes) size *= 2;
+	char* b = static_cast<char*>(::operator new(size));
+	blocks.push_back(b);
+	cur = b;
+	end = b + size;
+	// grow geometrically, but stop at 1MB per block
+	if (nextBlockSize < 1024 * 1024) nextBlockSize *= 2;
+}
+
+void* AstArena::do_allocate(size_t bytes, size_t alignment) {
+	auto align = [&](char* p) {
+		auto v = reinterpret_cast<std::uintptr_t>(p);
+		return reinterpret_cast<char*>((v + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+	};
+	char* p = cur ? align(cur) : nullptr;
+	if (!p || p + bytes > end) {
+		grow(bytes + alignment);
+		p = align(cur);
+	}
+	cur = p + bytes;
+	allocations++;
+	used += bytes;
+	return p;
+}
+
+void AstArena::do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/) {
+	// individual frees are no-ops; everything goes away with the arena
+}
+
+bool AstArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+	return this == &other;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Bump-pointer arena for AST nodes and their child lists.
+// Memory is carved out of large blocks and is only returned when the arena
+// itself is destroyed, so a whole tree is released with a handful of frees.
+class AstArena : public std::pmr::memory_resource {
+public:
+	explicit AstArena(size_t firstBlockSize = 64 * 1024);
+	~AstArena() override;
+
+	AstArena(const AstArena&) = delete;
+	AstArena& operator=(const AstArena&) = delete;
+
+	// statistics
+	size_t allocationCount() const { return allocations; }
+	size_t bytesUsed() const { return used; }
+	size_t blockCount() const { return blocks.size(); }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+	std::vector<char*> blocks;
+	char* cur = nullptr;
+	char* end = nullptr;
+	size_t nextBlockSize;
+	size_t allocations = 0;
+	size_t used = 0;
+
+	void grow(size_t minBytes);
+};
@@ -0,0 +1,446 @@
+#include "AstPrinter.hpp"
+
+#include <charconv>
+
+namespace {
+
+// Output is handed to the stream once this much has piled up.
+constexpr size_t kFlushBytes = 64 * 1024;
+
+// Indents are slices of this run; deeper trees append it repeatedly.
+const std::string& spaceRun() {
+	static const std::string run(256, ' ');
+	return run;
+}
+
+} // namespace
+
+const std::string& AstPrinter::print(const Program& prog) {
+	out.clear();
+	sink = nullptr;
+	indent = 0;
+	visitProgram(prog);
+	return out;
+}
+
+void AstPrinter::print(const Program& prog, std::ostream& os) {
+	out.clear();
+	sink = &os;
+	indent = 0;
+	visitProgram(prog);
+	os.write(out.data(), static_cast<std::streamsize>(out.size()));
+	out.clear();
+	sink = nullptr;
+}
+
+const std::string& AstPrinter::printNode(const ASTNode& node, int startIndent) {
+	out.clear();
+	sink = nullptr;
+	indent = startIndent;
+	visitNode(node);
+	return out;
+}
+
+void AstPrinter::visitNode(const ASTNode& n) {
+	switch (n.kind) {
+		case NodeKind::Program: visitProgram(static_cast<const Program&>(n)); break;
+		case NodeKind::VarDecl:
+		case NodeKind::FunDecl: visitDecl(static_cast<const Decl&>(n)); break;
+		case NodeKind::Param: visitParam(static_cast<const Param&>(n)); break;
+		case NodeKind::CompoundStmt:
+		case NodeKind::IfStmt:
+		case NodeKind::WhileStmt:
+		case NodeKind::ForStmt:
+		case NodeKind::ReturnStmt:
+		case NodeKind::ExprStmt: visitStmt(static_cast<const Stmt&>(n)); break;
+		default: visitExpr(static_cast<const Expr&>(n)); break;
+	}
+}
+
+void AstPrinter::visitProgram(const Program& p) {
+	open(p, "Program");
+	endHeader();
+	if (format == AstFormat::SExpr) {
+		for (const auto& d : p.decls) {
+			if (!d) continue;
+			out += "\n  ";
+			visitDecl(*d);
+		}
+	} else {
+		bareField("decls");
+		list(p.decls);
+		endBareField();
+	}
+	close();
+	if (format != AstFormat::Text) out += '\n';
+}
+
+void AstPrinter::visitVarDecl(const VarDecl& d) {
+	open(d, "VarDecl");
+	word("type", typeSpelling(d.type));
+	word("name", d.name);
+	endHeader();
+	field("init");
+	child(d.init.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitFunDecl(const FunDecl& d) {
+	open(d, "FunDecl");
+	word("type", typeSpelling(d.returnType));
+	word("name", d.name);
+	endHeader();
+	field("params");
+	if (format == AstFormat::Text && d.params.empty()) {
+		spaces(indent);
+		out += "(none)\n";
+	} else {
+		list(d.params);
+	}
+	endField();
+	field("body");
+	child(d.body.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitParam(const Param& p) {
+	open(p, "Param");
+	word("type", typeSpelling(p.type));
+	word("name", p.name);
+	endHeader();
+	close();
+}
+
+void AstPrinter::visitCompoundStmt(const CompoundStmt& s) {
+	open(s, "Compound");
+	endHeader();
+	// the text layout leaves out empty sections
+	if (format != AstFormat::Text || !s.localVars.empty()) {
+		field("locals");
+		list(s.localVars);
+		endField();
+	}
+	if (format != AstFormat::Text || !s.stmts.empty()) {
+		field("statements");
+		list(s.stmts);
+		endField();
+	}
+	close();
+}
+
+void AstPrinter::visitIfStmt(const IfStmt& s) {
+	open(s, "If");
+	endHeader();
+	field("cond");
+	child(s.cond.get());
+	endField();
+	field("then");
+	child(s.thenBranch.get());
+	endField();
+	field("else");
+	child(s.elseBranch.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitWhileStmt(const WhileStmt& s) {
+	open(s, "While");
+	endHeader();
+	field("cond");
+	child(s.cond.get());
+	endField();
+	field("body");
+	child(s.body.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitForStmt(const ForStmt& s) {
+	open(s, "For");
+	endHeader();
+	field("init");
+	child(s.init.get());
+	endField();
+	field("cond");
+	child(s.cond.get());
+	endField();
+	field("update");
+	child(s.update.get());
+	endField();
+	field("body");
+	child(s.body.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitReturnStmt(const ReturnStmt& s) {
+	open(s, "Return");
+	endHeader();
+	field("expr");
+	child(s.expr.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitExprStmt(const ExprStmt& s) {
+	open(s, "ExprStmt");
+	endHeader();
+	field("expr");
+	child(s.expr.get());
+	endField();
+	close();
+}
+
+void AstPrinter::visitAssignExpr(const AssignExpr& e) {
+	open(e, "Assign");
+	endHeader();
+	bareField("left");
+	child(e.left.get());
+	endBareField();
+	bareField("right");
+	child(e.right.get());
+	endBareField();
+	close();
+}
+
+void AstPrinter::visitBinaryExpr(const BinaryExpr& e) {
+	open(e, "Binary");
+	word("op", opSpelling(e.op));
+	endHeader();
+	bareField("left");
+	child(e.left.get());
+	endBareField();
+	bareField("right");
+	child(e.right.get());
+	endBareField();
+	close();
+}
+
+void AstPrinter::visitUnaryExpr(const UnaryExpr& e) {
+	open(e, "Unary");
+	word("op", opSpelling(e.op));
+	endHeader();
+	bareField("operand");
+	child(e.operand.get());
+	endBareField();
+	close();
+}
+
+void AstPrinter::visitCallExpr(const CallExpr& e) {
+	open(e, "Call");
+	word("name", e.name);
+	endHeader();
+	if (format == AstFormat::Text && e.args.empty()) {
+		spaces(indent + 2);
+		out += "args: (none)\n";
+	} else {
+		field("args");
+		list(e.args);
+		endField();
+	}
+	close();
+}
+
+void AstPrinter::visitValExpr(const ValExpr& e) {
+	open(e, "Var");
+	word("name", e.name);
+	endHeader();
+	close();
+}
+
+void AstPrinter::visitIntLiteral(const IntLiteral& e) {
+	open(e, "Int");
+	word("value", e.lexeme);
+	endHeader();
+	close();
+}
+
+void AstPrinter::visitCharLiteral(const CharLiteral& e) {
+	open(e, "Char");
+	word("value", e.lexeme);
+	endHeader();
+	close();
+}
+
+void AstPrinter::visitDoubleLiteral(const DoubleLiteral& e) {
+	open(e, "Double");
+	word("value", e.lexeme);
+	endHeader();
+	close();
+}
+
+void AstPrinter::child(const ASTNode* n) {
+	switch (format) {
+		case AstFormat::Text:
+			if (n) {
+				visitNode(*n);
+			} else {
+				spaces(indent);
+				out += "(empty)\n";
+			}
+			break;
+		case AstFormat::SExpr:
+			out += ' ';
+			if (n) visitNode(*n);
+			else out += "nil";
+			break;
+		case AstFormat::Json:
+			if (n) visitNode(*n);
+			else out += "null";
+			break;
+	}
+}
+
+template<class T>
+void AstPrinter::list(const NodeList<T>& items) {
+	if (format != AstFormat::Json) {
+		for (const auto& n : items) {
+			if (n) child(n.get());
+		}
+		return;
+	}
+	out += '[';
+	bool first = true;
+	for (const auto& n : items) {
+		if (!n) continue;
+		if (!first) out += ',';
+		first = false;
+		visitNode(*n);
+	}
+	out += ']';
+}
+
+void AstPrinter::open(const ASTNode& n, const char* kind) {
+	flushIfFull();
+	switch (format) {
+		case AstFormat::Text:
+			spaces(indent);
+			out += kind;
+			break;
+		case AstFormat::SExpr:
+			out += '(';
+			out += kind;
+			break;
+		case AstFormat::Json:
+			out += "{\"kind\":\"";
+			out += kind;
+			out += "\",\"begin\":";
+			number(n.begin);
+			out += ",\"end\":";
+			number(n.end);
+			break;
+	}
+}
+
+void AstPrinter::endHeader() {
+	if (format == AstFormat::Text) out += '\n';
+}
+
+void AstPrinter::close() {
+	if (format == AstFormat::SExpr) out += ')';
+	else if (format == AstFormat::Json) out += '}';
+}
+
+void AstPrinter::field(const char* label) {
+	switch (format) {
+		case AstFormat::Text:
+			spaces(indent + 2);
+			out += label;
+			out += ":\n";
+			indent += 4;
+			break;
+		case AstFormat::SExpr:
+			out += " (";
+			out += label;
+			break;
+		case AstFormat::Json:
+			out += ",\"";
+			out += label;
+			out += "\":";
+			break;
+	}
+}
+
+void AstPrinter::endField() {
+	if (format == AstFormat::Text) indent -= 4;
+	else if (format == AstFormat::SExpr) out += ')';
+}
+
+void AstPrinter::bareField(const char* label) {
+	if (format == AstFormat::Text) {
+		indent += 2;
+	} else if (format == AstFormat::Json) {
+		out += ",\"";
+		out += label;
+		out += "\":";
+	}
+}
+
+void AstPrinter::endBareField() {
+	if (format == AstFormat::Text) indent -= 2;
+}
+
+void AstPrinter::word(const char* label, const std::string& s) {
+	if (format == AstFormat::Json) {
+		out += ",\"";
+		out += label;
+		out += "\":";
+		jsonString(s);
+	} else {
+		out += ' ';
+		out += s;
+	}
+}
+
+void AstPrinter::word(const char* label, const char* s) {
+	if (format == AstFormat::Json) {
+		out += ",\"";
+		out += label;
+		out += "\":\"";
+		out += s;	// types and operators need no escaping
+		out += '"';
+	} else {
+		out += ' ';
+		out += s;
+	}
+}
+
+void AstPrinter::spaces(int n) {
+	const std::string& run = spaceRun();
+	for (; n > static_cast<int>(run.size()); n -= static_cast<int>(run.size())) out += run;
+	if (n > 0) out.append(run.data(), static_cast<size_t>(n));
+}
+
+void AstPrinter::number(uint32_t v) {
+	char buf[16];
+	auto r = std::to_chars(buf, buf + sizeof(buf), v);
+	out.append(buf, r.ptr);
+}
+
+void AstPrinter::jsonString(const std::string& s) {
+	static const char hex[] = "0123456789abcdef";
+	out += '"';
+	for (char c : s) {
+		unsigned char u = static_cast<unsigned char>(c);
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if (u < 0x20) {
+			out += "\\u00";
+			out += hex[u >> 4];
+			out += hex[u & 0xF];
+		} else {
+			out += c;
+		}
+	}
+	out += '"';
+}
+
+void AstPrinter::flushIfFull() {
+	if (sink && out.size() >= kFlushBytes) {
+		sink->write(out.data(), static_cast<std::streamsize>(out.size()));
+		out.clear();
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "AST.hpp"
+#include "AstVisitor.hpp"
+
+#include <ostream>
+#include <string>
+#include <utility>
+
+enum class AstFormat {
+	Text,	// indented tree, the dumpAstToString layout
+	SExpr,	// one S-expression per top-level declaration
+	Json,	// one JSON object, no whitespace; nodes carry kind, begin, end
+};
+
+// Renders an AST by appending straight into one output buffer: indents come
+// from a shared run of spaces, numbers go through to_chars, and nothing is
+// built per node. Keep a printer around to reuse the buffer's capacity.
+//
+// Null children print as "(empty)" / nil / null; null list entries are
+// skipped, as dumpAstToString does.
+class AstPrinter : public DeclVisitor<AstPrinter>,
+                   public StmtVisitor<AstPrinter>,
+                   public ExprVisitor<AstPrinter> {
+public:
+	explicit AstPrinter(AstFormat format = AstFormat::Text) : format(format) {}
+
+	// The returned text stays valid until the next call.
+	const std::string& print(const Program& prog);
+	// Writes to os in chunks instead of holding the whole text.
+	void print(const Program& prog, std::ostream& os);
+	// A single subtree, starting at the given indent (Text only).
+	const std::string& printNode(const ASTNode& node, int indent = 0);
+	// Hands over the last printed text instead of copying it.
+	std::string release() { return std::move(out); }
+
+	void visitVarDecl(const VarDecl& d);
+	void visitFunDecl(const FunDecl& d);
+	void visitCompoundStmt(const CompoundStmt& s);
+	void visitIfStmt(const IfStmt& s);
+	void visitWhileStmt(const WhileStmt& s);
+	void visitForStmt(const ForStmt& s);
+	void visitReturnStmt(const ReturnStmt& s);
+	void visitExprStmt(const ExprStmt& s);
+	void visitAssignExpr(const AssignExpr& e);
+	void visitBinaryExpr(const BinaryExpr& e);
+	void visitUnaryExpr(const UnaryExpr& e);
+	void visitCallExpr(const CallExpr& e);
+	void visitValExpr(const ValExpr& e);
+	void visitIntLiteral(const IntLiteral& e);
+	void visitCharLiteral(const CharLiteral& e);
+	void visitDoubleLiteral(const DoubleLiteral& e);
+
+private:
+	AstFormat format;
+	std::string out;
+	std::ostream* sink = nullptr;
+	int indent = 0;
+
+	void visitProgram(const Program& p);
+	void visitParam(const Param& p);
+	void visitNode(const ASTNode& n);
+	void child(const ASTNode* n);
+	template<class T>
+	void list(const NodeList<T>& items);
+
+	// Node layout helpers. Text: "Kind words" line, then "label:" lines
+	// with children indented below. SExpr: (Kind words (label child...)).
+	// Json: {"kind":..,"begin":..,"end":.., "key":word.., "label":child..}.
+	void open(const ASTNode& n, const char* kind);
+	void word(const char* label, const std::string& s);
+	void word(const char* label, const char* s);
+	void endHeader();
+	void close();
+	void field(const char* label);
+	void endField();
+	// a field with no label in the Text and SExpr layouts
+	void bareField(const char* label);
+	void endBareField();
+
+	void spaces(int n);
+	void number(uint32_t v);
+	void jsonString(const std::string& s);
+	void flushIfFull();
+};
@@ -0,0 +1,477 @@
+#include "AstSerializer.hpp"
+#include "AstVisitor.hpp"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[4] = {'C', 'A', 'S', 'T'};
+constexpr uint8_t kNullNode = 0xFF;
+
+template<class T>
+void put(std::string& out, T v) {
+	out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+class AstWriter : public DeclVisitor<AstWriter>,
+                  public StmtVisitor<AstWriter>,
+                  public ExprVisitor<AstWriter> {
+public:
+	std::string body;
+	std::vector<const std::string*> strings;
+
+	void writeProgram(const Program& prog) {
+		header(prog);
+		put<uint32_t>(body, static_cast<uint32_t>(prog.decls.size()));
+		for (const auto& d : prog.decls) optDecl(d.get());
+	}
+
+	void visitVarDecl(const VarDecl& d) {
+		header(d);
+		put(body, d.type);
+		str(d.name);
+		optExpr(d.init);
+	}
+
+	void visitFunDecl(const FunDecl& d) {
+		header(d);
+		put(body, d.returnType);
+		str(d.name);
+		put<uint32_t>(body, static_cast<uint32_t>(d.params.size()));
+		for (const auto& p : d.params) {
+			if (!p) {
+				put(body, kNullNode);
+				continue;
+			}
+			header(*p);
+			put(body, p->type);
+			str(p->name);
+		}
+		if (d.body) visitCompoundStmt(*d.body);
+		else put(body, kNullNode);
+	}
+
+	void visitCompoundStmt(const CompoundStmt& s) {
+		header(s);
+		put<uint32_t>(body, static_cast<uint32_t>(s.localVars.size()));
+		for (const auto& v : s.localVars) {
+			if (v) visitVarDecl(*v);
+			else put(body, kNullNode);
+		}
+		put<uint32_t>(body, static_cast<uint32_t>(s.stmts.size()));
+		for (const auto& st : s.stmts) optStmt(st);
+	}
+
+	void visitIfStmt(const IfStmt& s) {
+		header(s);
+		optExpr(s.cond);
+		optStmt(s.thenBranch);
+		optStmt(s.elseBranch);
+	}
+
+	void visitWhileStmt(const WhileStmt& s) {
+		header(s);
+		optExpr(s.cond);
+		optStmt(s.body);
+	}
+
+	void visitForStmt(const ForStmt& s) {
+		header(s);
+		optExpr(s.init);
+		optExpr(s.cond);
+		optExpr(s.update);
+		optStmt(s.body);
+	}
+
+	void visitReturnStmt(const ReturnStmt& s) {
+		header(s);
+		optExpr(s.expr);
+	}
+
+	void visitExprStmt(const ExprStmt& s) {
+		header(s);
+		optExpr(s.expr);
+	}
+
+	void visitAssignExpr(const AssignExpr& e) {
+		header(e);
+		optExpr(e.left);
+		optExpr(e.right);
+	}
+
+	void visitBinaryExpr(const BinaryExpr& e) {
+		header(e);
+		put(body, e.op);
+		optExpr(e.left);
+		optExpr(e.right);
+	}
+
+	void visitUnaryExpr(const UnaryExpr& e) {
+		header(e);
+		put(body, e.op);
+		optExpr(e.operand);
+	}
+
+	void visitCallExpr(const CallExpr& e) {
+		header(e);
+		str(e.name);
+		put<uint32_t>(body, static_cast<uint32_t>(e.args.size()));
+		for (const auto& a : e.args) optExpr(a);
+	}
+
+	void visitValExpr(const ValExpr& e) { leaf(e, e.name); }
+	void visitIntLiteral(const IntLiteral& e) { leaf(e, e.lexeme); }
+	void visitCharLiteral(const CharLiteral& e) { leaf(e, e.lexeme); }
+	void visitDoubleLiteral(const DoubleLiteral& e) { leaf(e, e.lexeme); }
+
+private:
+	std::unordered_map<std::string, uint32_t> stringIds;
+
+	void header(const ASTNode& n) {
+		put(body, static_cast<uint8_t>(n.kind));
+		put(body, n.begin);
+		put(body, n.end);
+	}
+
+	void str(const std::string& s) {
+		auto it = stringIds.find(s);
+		if (it == stringIds.end()) {
+			it = stringIds.emplace(s, static_cast<uint32_t>(strings.size())).first;
+			strings.push_back(&it->first);
+		}
+		put(body, it->second);
+	}
+
+	void leaf(const ASTNode& n, const std::string& s) {
+		header(n);
+		str(s);
+	}
+
+	void optDecl(const Decl* d) {
+		if (d) visitDecl(*d);
+		else put(body, kNullNode);
+	}
+	void optStmt(const StmtPtr& s) {
+		if (s) visitStmt(*s);
+		else put(body, kNullNode);
+	}
+	void optExpr(const ExprPtr& e) {
+		if (e) visitExpr(*e);
+		else put(body, kNullNode);
+	}
+};
+
+// Reads the node stream back into arena nodes; every read is bounds-checked.
+class AstReader {
+public:
+	AstReader(const char* begin, const char* end, AstArena& arena) : cur(begin), last(end), arena(arena) {}
+
+	template<class T>
+	T get() {
+		if (static_cast<size_t>(last - cur) < sizeof(T)) throw AstFormatError("truncated AST data");
+		T v;
+		std::memcpy(&v, cur, sizeof(T));
+		cur += sizeof(T);
+		return v;
+	}
+
+	std::string getString() {
+		uint32_t len = get<uint32_t>();
+		if (static_cast<size_t>(last - cur) < len) throw AstFormatError("truncated AST data");
+		std::string s(cur, len);
+		cur += len;
+		return s;
+	}
+
+	bool atEnd() const { return cur == last; }
+
+	std::vector<std::string> strings;
+
+	void readProgram(Program& prog) {
+		NodeKind k = readKind();
+		if (null || k != NodeKind::Program) throw AstFormatError("AST data does not start with a program");
+		range(prog);
+		uint32_t n = count();
+		prog.decls.reserve(n);
+		for (uint32_t i = 0; i < n; ++i) prog.decls.push_back(readDecl());
+	}
+
+private:
+	const char* cur;
+	const char* last;
+	AstArena& arena;
+	bool null = false;	// the last readKind() hit kNullNode
+	std::vector<NameId> nameIds;	// by string id
+
+	NodeKind readKind() {
+		uint8_t k = get<uint8_t>();
+		null = k == kNullNode;
+		if (null) return NodeKind::Program;
+		if (k > static_cast<uint8_t>(NodeKind::CallExpr)) throw AstFormatError("bad node kind in AST data");
+		return static_cast<NodeKind>(k);
+	}
+
+	void range(ASTNode& n) {
+		n.begin = get<uint32_t>();
+		n.end = get<uint32_t>();
+	}
+
+	// a list count can never exceed the bytes left, which bounds reserve()
+	uint32_t count() {
+		uint32_t n = get<uint32_t>();
+		if (n > static_cast<size_t>(last - cur)) throw AstFormatError("bad list length in AST data");
+		return n;
+	}
+
+	uint32_t strId() {
+		uint32_t id = get<uint32_t>();
+		if (id >= strings.size()) throw AstFormatError("bad string id in AST data");
+		return id;
+	}
+
+	const std::string& str() { return strings[strId()]; }
+
+	// an identifier: its spelling plus its id, interned once per string
+	template<class T>
+	void name(T& node) {
+		uint32_t id = strId();
+		if (nameIds.size() < strings.size()) nameIds.resize(strings.size(), kNoName);
+		if (nameIds[id] == kNoName) nameIds[id] = identifiers().intern(strings[id]);
+		node.name = strings[id];
+		node.nameId = nameIds[id];
+	}
+
+	Type type() {
+		uint8_t t = get<uint8_t>();
+		if (t > static_cast<uint8_t>(Type::DOUBLE)) throw AstFormatError("bad type in AST data");
+		return static_cast<Type>(t);
+	}
+
+	template<class Op>
+	Op op(Op lastOp) {
+		uint8_t o = get<uint8_t>();
+		if (o > static_cast<uint8_t>(lastOp)) throw AstFormatError("bad operator in AST data");
+		return static_cast<Op>(o);
+	}
+
+	template<class T>
+	NodePtr<T> node() {
+		auto n = makeNode<T>(arena);
+		range(*n);
+		return n;
+	}
+
+	DeclPtr readDecl() {
+		NodeKind k = readKind();
+		if (null) return nullptr;
+		if (k == NodeKind::VarDecl) return readVarDecl();
+		if (k == NodeKind::FunDecl) return readFunDecl();
+		throw AstFormatError("expected a declaration in AST data");
+	}
+
+	NodePtr<VarDecl> readVarDecl() {
+		auto d = node<VarDecl>();
+		d->type = type();
+		name(*d);
+		d->init = readExpr();
+		return d;
+	}
+
+	NodePtr<FunDecl> readFunDecl() {
+		auto d = node<FunDecl>();
+		d->returnType = type();
+		name(*d);
+		uint32_t n = count();
+		d->params.reserve(n);
+		for (uint32_t i = 0; i < n; ++i) {
+			NodeKind k = readKind();
+			if (null) {
+				d->params.push_back(nullptr);
+				continue;
+			}
+			if (k != NodeKind::Param) throw AstFormatError("expected a parameter in AST data");
+			auto p = node<Param>();
+			p->type = type();
+			name(*p);
+			d->params.push_back(std::move(p));
+		}
+		NodeKind k = readKind();
+		if (!null) {
+			if (k != NodeKind::CompoundStmt) throw AstFormatError("expected a function body in AST data");
+			d->body = readCompoundStmt();
+		}
+		return d;
+	}
+
+	NodePtr<CompoundStmt> readCompoundStmt() {
+		auto s = node<CompoundStmt>();
+		uint32_t n = count();
+		s->localVars.reserve(n);
+		for (uint32_t i = 0; i < n; ++i) {
+			NodeKind k = readKind();
+			if (null) {
+				s->localVars.push_back(nullptr);
+				continue;
+			}
+			if (k != NodeKind::VarDecl) throw AstFormatError("expected a local variable in AST data");
+			s->localVars.push_back(readVarDecl());
+		}
+		n = count();
+		s->stmts.reserve(n);
+		for (uint32_t i = 0; i < n; ++i) s->stmts.push_back(readStmt());
+		return s;
+	}
+
+	StmtPtr readStmt() {
+		NodeKind k = readKind();
+		if (null) return nullptr;
+		switch (k) {
+			case NodeKind::CompoundStmt: return readCompoundStmt();
+			case NodeKind::IfStmt: {
+				auto s = node<IfStmt>();
+				s->cond = readExpr();
+				s->thenBranch = readStmt();
+				s->elseBranch = readStmt();
+				return s;
+			}
+			case NodeKind::WhileStmt: {
+				auto s = node<WhileStmt>();
+				s->cond = readExpr();
+				s->body = readStmt();
+				return s;
+			}
+			case NodeKind::ForStmt: {
+				auto s = node<ForStmt>();
+				s->init = readExpr();
+				s->cond = readExpr();
+				s->update = readExpr();
+				s->body = readStmt();
+				return s;
+			}
+			case NodeKind::ReturnStmt: {
+				auto s = node<ReturnStmt>();
+				s->expr = readExpr();
+				return s;
+			}
+			case NodeKind::ExprStmt: {
+				auto s = node<ExprStmt>();
+				s->expr = readExpr();
+				return s;
+			}
+			default: throw AstFormatError("expected a statement in AST data");
+		}
+	}
+
+	ExprPtr readExpr() {
+		NodeKind k = readKind();
+		if (null) return nullptr;
+		switch (k) {
+			case NodeKind::AssignExpr: {
+				auto e = node<AssignExpr>();
+				e->left = readExpr();
+				e->right = readExpr();
+				return e;
+			}
+			case NodeKind::BinaryExpr: {
+				auto e = node<BinaryExpr>();
+				e->op = op(BinaryOp::Or);
+				e->left = readExpr();
+				e->right = readExpr();
+				return e;
+			}
+			case NodeKind::UnaryExpr: {
+				auto e = node<UnaryExpr>();
+				e->op = op(UnaryOp::Not);
+				e->operand = readExpr();
+				return e;
+			}
+			case NodeKind::CallExpr: {
+				auto e = node<CallExpr>();
+				name(*e);
+				uint32_t n = count();
+				e->args.reserve(n);
+				for (uint32_t i = 0; i < n; ++i) e->args.push_back(readExpr());
+				return e;
+			}
+			case NodeKind::ValExpr: {
+				auto e = node<ValExpr>();
+				name(*e);
+				return e;
+			}
+			case NodeKind::IntLiteral: {
+				auto e = node<IntLiteral>();
+				e->lexeme = str();
+				return e;
+			}
+			case NodeKind::CharLiteral: {
+				auto e = node<CharLiteral>();
+				e->lexeme = str();
+				return e;
+			}
+			case NodeKind::DoubleLiteral: {
+				auto e = node<DoubleLiteral>();
+				e->lexeme = str();
+				return e;
+			}
+			default: throw AstFormatError("expected an expression in AST data");
+		}
+	}
+};
+
+} // namespace
+
+uint64_t hashSource(const std::string& text) {
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : text) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+std::string serializeProgram(const Program& prog, const LineMap& lines, uint64_t sourceHash) {
+	AstWriter writer;
+	writer.writeProgram(prog);
+
+	std::string out;
+	out.append(kMagic, sizeof(kMagic));
+	put(out, kAstFormatVersion);
+	put(out, sourceHash);
+	put<uint32_t>(out, static_cast<uint32_t>(writer.strings.size()));
+	put<uint32_t>(out, static_cast<uint32_t>(lines.lineCount()));
+	for (const std::string* s : writer.strings) {
+		put<uint32_t>(out, static_cast<uint32_t>(s->size()));
+		out += *s;
+	}
+	for (size_t i = 0; i < lines.lineCount(); ++i) put(out, lines.lineStart(i));
+	out += writer.body;
+	return out;
+}
+
+ProgramPtr deserializeProgram(const std::string& data, uint64_t sourceHash, LineMap& lines) {
+	auto prog = std::make_unique<Program>();
+	AstReader reader(data.data(), data.data() + data.size(), *prog->arena);
+
+	char magic[sizeof(kMagic)];
+	for (char& c : magic) c = reader.get<char>();
+	if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) throw AstFormatError("not AST data");
+	if (reader.get<uint32_t>() != kAstFormatVersion) return nullptr;
+	if (reader.get<uint64_t>() != sourceHash) return nullptr;
+
+	uint32_t stringCount = reader.get<uint32_t>();
+	uint32_t lineCount = reader.get<uint32_t>();
+	if (stringCount > data.size() || lineCount == 0 || lineCount > data.size()) {
+		throw AstFormatError("bad AST data header");
+	}
+	reader.strings.reserve(stringCount);
+	for (uint32_t i = 0; i < stringCount; ++i) reader.strings.push_back(reader.getString());
+	lines.clear();
+	if (reader.get<uint32_t>() != 0) throw AstFormatError("bad line table in AST data");
+	for (uint32_t i = 1; i < lineCount; ++i) lines.addLineStart(reader.get<uint32_t>());
+
+	reader.readProgram(*prog);
+	if (!reader.atEnd()) throw AstFormatError("trailing bytes after AST data");
+	return prog;
+}
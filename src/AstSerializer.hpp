@@ -0,0 +1,38 @@
+#pragma once
+
+#include "AST.hpp"
+#include "LineMap.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Bump whenever the layout below or a node in AST.hpp changes; data written
+// by another version is treated as a cache miss.
+constexpr uint32_t kAstFormatVersion = 2;
+
+class AstFormatError : public std::runtime_error {
+public:
+	explicit AstFormatError(const std::string& msg) : std::runtime_error(msg) {}
+};
+
+// 64-bit FNV-1a of the source text; keys and validates cached trees.
+uint64_t hashSource(const std::string& text);
+
+// Binary form of a parsed program, for an on-disk compile cache.
+//
+// Layout, in host byte order (a cache does not move between machines):
+//   header   "CAST", u32 version, u64 source hash, u32 string count,
+//            u32 line count
+//   strings  u32 length + bytes each; names and lexemes, deduplicated
+//   lines    u32 line starts of the LineMap
+//   nodes    pre-order from the Program; per node u8 kind (kNullNode for a
+//            missing child), u32 begin, u32 end, then its fields in AST.hpp
+//            order: u8 for Type and operators, u32 string id for names and
+//            lexemes, u32 count ahead of each child list
+std::string serializeProgram(const Program& prog, const LineMap& lines, uint64_t sourceHash);
+
+// Rebuilds a program and its line map in one pass over data. Returns
+// nullptr if data has another format version or source hash; throws
+// AstFormatError if it is truncated or malformed.
+ProgramPtr deserializeProgram(const std::string& data, uint64_t sourceHash, LineMap& lines);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AST.hpp"
+
+// CRTP visitors: one switch on ASTNode::kind, then a static call into the
+// derived pass. A pass implements visitXxx for every concrete node of the
+// category it visits; a missing hook is a compile error, not a silent fallthrough.
+//
+//   class MyPass : public ExprVisitor<MyPass, int> {
+//   public:
+//       int visitBinaryExpr(const BinaryExpr& e);
+//       ...
+//   };
+
+template<class Derived, class R = void>
+class DeclVisitor {
+public:
+	R visitDecl(const Decl& d) {
+		Derived& self = static_cast<Derived&>(*this);
+		switch (d.kind) {
+			case NodeKind::VarDecl: return self.visitVarDecl(static_cast<const VarDecl&>(d));
+			case NodeKind::FunDecl: return self.visitFunDecl(static_cast<const FunDecl&>(d));
+			default: return R();
+		}
+	}
+};
+
+template<class Derived, class R = void>
+class StmtVisitor {
+public:
+	R visitStmt(const Stmt& s) {
+		Derived& self = static_cast<Derived&>(*this);
+		switch (s.kind) {
+			case NodeKind::CompoundStmt: return self.visitCompoundStmt(static_cast<const CompoundStmt&>(s));
+			case NodeKind::IfStmt: return self.visitIfStmt(static_cast<const IfStmt&>(s));
+			case NodeKind::WhileStmt: return self.visitWhileStmt(static_cast<const WhileStmt&>(s));
+			case NodeKind::ForStmt: return self.visitForStmt(static_cast<const ForStmt&>(s));
+			case NodeKind::ReturnStmt: return self.visitReturnStmt(static_cast<const ReturnStmt&>(s));
+			case NodeKind::ExprStmt: return self.visitExprStmt(static_cast<const ExprStmt&>(s));
+			default: return R();
+		}
+	}
+};
+
+template<class Derived, class R = void>
+class ExprVisitor {
+public:
+	R visitExpr(const Expr& e) {
+		Derived& self = static_cast<Derived&>(*this);
+		switch (e.kind) {
+			case NodeKind::AssignExpr: return self.visitAssignExpr(static_cast<const AssignExpr&>(e));
+			case NodeKind::BinaryExpr: return self.visitBinaryExpr(static_cast<const BinaryExpr&>(e));
+			case NodeKind::UnaryExpr: return self.visitUnaryExpr(static_cast<const UnaryExpr&>(e));
+			case NodeKind::CallExpr: return self.visitCallExpr(static_cast<const CallExpr&>(e));
+			case NodeKind::ValExpr: return self.visitValExpr(static_cast<const ValExpr&>(e));
+			case NodeKind::IntLiteral: return self.visitIntLiteral(static_cast<const IntLiteral&>(e));
+			case NodeKind::CharLiteral: return self.visitCharLiteral(static_cast<const CharLiteral&>(e));
+			case NodeKind::DoubleLiteral: return self.visitDoubleLiteral(static_cast<const DoubleLiteral&>(e));
+			default: return R();
+		}
+	}
+};
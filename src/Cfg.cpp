@@ -0,0 +1,264 @@
+#include "Cfg.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+void addEdge(Cfg& cfg, uint32_t from, uint32_t to) {
+	if (to == kNoBlock) return;
+	std::vector<uint32_t>& succs = cfg.blocks[from].succs;
+	// both arms of a conditional jump may lead to the same block
+	if (std::find(succs.begin(), succs.end(), to) != succs.end()) return;
+	succs.push_back(to);
+	cfg.blocks[to].preds.push_back(from);
+}
+
+// Leaders are the first instruction, every label (a run of labels shares one
+// block), and whatever follows a jump or return.
+void splitBlocks(const TacFunction& fn, Cfg& cfg) {
+	const std::vector<TacInstr>& code = fn.code;
+	uint32_t lo = ~0u, hi = 0;
+	for (const TacInstr& in : code) {
+		if (in.op == TacOp::Label) {
+			lo = std::min(lo, in.a.id);
+			hi = std::max(hi, in.a.id);
+		}
+	}
+	if (lo <= hi) {
+		cfg.labelBase = lo;
+		cfg.labelBlocks.assign(hi - lo + 1, kNoBlock);
+	}
+
+	uint32_t n = static_cast<uint32_t>(code.size());
+	uint32_t start = 0;
+	for (uint32_t i = 0; i <= n; ++i) {
+		bool cut = i == n ||
+			(i > start && code[i].op == TacOp::Label && code[i - 1].op != TacOp::Label) ||
+			(i > 0 && i > start && endsBlock(code[i - 1].op));
+		if (!cut) continue;
+		if (i > start || cfg.blocks.empty()) {
+			BasicBlock b;
+			b.begin = start;
+			b.end = i;
+			cfg.blocks.push_back(std::move(b));
+		}
+		start = i;
+	}
+	for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+		const BasicBlock& bb = cfg.blocks[b];
+		for (uint32_t i = bb.begin; i < bb.end && code[i].op == TacOp::Label; ++i) {
+			cfg.labelBlocks[code[i].a.id - cfg.labelBase] = b;
+		}
+	}
+}
+
+void linkBlocks(const TacFunction& fn, Cfg& cfg) {
+	uint32_t count = static_cast<uint32_t>(cfg.blocks.size());
+	for (uint32_t b = 0; b < count; ++b) {
+		const BasicBlock& bb = cfg.blocks[b];
+		uint32_t next = b + 1 < count ? b + 1 : kNoBlock;
+		if (bb.begin == bb.end) {
+			addEdge(cfg, b, next);
+			continue;
+		}
+		const TacInstr& last = fn.code[bb.end - 1];
+		switch (last.op) {
+			case TacOp::Goto:
+				addEdge(cfg, b, cfg.blockOfLabel(last.a.id));
+				break;
+			case TacOp::IfGoto:
+				addEdge(cfg, b, cfg.blockOfLabel(last.b.id));
+				addEdge(cfg, b, next);
+				break;
+			case TacOp::Return:
+				break;
+			default:
+				addEdge(cfg, b, next);
+				break;
+		}
+	}
+}
+
+// One depth-first search from the entry gives the reverse postorder in
+// cfg.order and the preorder and spanning tree the dominator pass needs.
+void searchDepthFirst(Cfg& cfg, std::vector<uint32_t>& preorder, std::vector<uint32_t>& parent) {
+	std::vector<uint32_t> post;
+	post.reserve(cfg.blocks.size());
+	std::vector<char> seen(cfg.blocks.size(), 0);
+	parent.assign(cfg.blocks.size(), kNoBlock);
+	// (block, next successor to visit)
+	std::vector<std::pair<uint32_t, uint32_t>> stack;
+	stack.emplace_back(0, 0);
+	seen[0] = 1;
+	preorder.push_back(0);
+	while (!stack.empty()) {
+		auto& [b, next] = stack.back();
+		const std::vector<uint32_t>& succs = cfg.blocks[b].succs;
+		if (next < succs.size()) {
+			uint32_t s = succs[next++];
+			if (!seen[s]) {
+				seen[s] = 1;
+				parent[s] = b;
+				preorder.push_back(s);
+				stack.emplace_back(s, 0);
+			}
+			continue;
+		}
+		post.push_back(b);
+		stack.pop_back();
+	}
+	cfg.order.assign(post.rbegin(), post.rend());
+	for (uint32_t i = 0; i < cfg.order.size(); ++i) {
+		cfg.blocks[cfg.order[i]].rpo = i;
+	}
+}
+
+// Lengauer and Tarjan, "A Fast Algorithm for Finding Dominators in a
+// Flowgraph", the simple version with path compression: O(E log V) even on
+// deep loop nests, where the iterative algorithms go quadratic. Everything
+// is indexed by block; semi holds preorder numbers, the rest block ids.
+void computeDominators(Cfg& cfg, const std::vector<uint32_t>& preorder, const std::vector<uint32_t>& parent) {
+	std::vector<BasicBlock>& blocks = cfg.blocks;
+	size_t count = blocks.size();
+	std::vector<uint32_t> number(count, kNoBlock);
+	for (uint32_t i = 0; i < preorder.size(); ++i) {
+		number[preorder[i]] = i;
+	}
+	std::vector<uint32_t> semi(number), label(count), ancestor(count, kNoBlock);
+	for (uint32_t b = 0; b < count; ++b) {
+		label[b] = b;
+	}
+	std::vector<uint32_t> idom(count, kNoBlock);
+	std::vector<std::vector<uint32_t>> bucket(count);
+	std::vector<uint32_t> path;
+
+	// the block with the smallest semi on v's path up the forest built so far
+	auto eval = [&](uint32_t v) {
+		if (ancestor[v] == kNoBlock) return v;
+		path.clear();
+		for (uint32_t x = v; ancestor[ancestor[x]] != kNoBlock; x = ancestor[x]) {
+			path.push_back(x);
+		}
+		for (size_t i = path.size(); i-- > 0;) {
+			uint32_t x = path[i];
+			uint32_t a = ancestor[x];
+			if (semi[label[a]] < semi[label[x]]) label[x] = label[a];
+			ancestor[x] = ancestor[a];
+		}
+		return label[v];
+	};
+
+	for (size_t i = preorder.size(); i-- > 1;) {
+		uint32_t w = preorder[i];
+		for (uint32_t v : blocks[w].preds) {
+			if (number[v] == kNoBlock) continue;
+			uint32_t u = eval(v);
+			if (semi[u] < semi[w]) semi[w] = semi[u];
+		}
+		bucket[preorder[semi[w]]].push_back(w);
+		uint32_t p = parent[w];
+		ancestor[w] = p;
+		for (uint32_t v : bucket[p]) {
+			uint32_t u = eval(v);
+			idom[v] = semi[u] < semi[v] ? u : p;
+		}
+		bucket[p].clear();
+	}
+	for (size_t i = 1; i < preorder.size(); ++i) {
+		uint32_t w = preorder[i];
+		if (idom[w] != preorder[semi[w]]) idom[w] = idom[idom[w]];
+	}
+	idom[0] = 0;
+
+	for (uint32_t b : cfg.order) {
+		blocks[b].idom = idom[b];
+		if (b != 0) blocks[idom[b]].domChildren.push_back(b);
+	}
+	// pre/post numbers of the dominator tree answer dominates() in constant time
+	uint32_t counter = 0;
+	std::vector<std::pair<uint32_t, size_t>> stack;
+	stack.emplace_back(0, 0);
+	blocks[0].domPre = counter++;
+	while (!stack.empty()) {
+		auto& [b, next] = stack.back();
+		if (next < blocks[b].domChildren.size()) {
+			uint32_t c = blocks[b].domChildren[next++];
+			blocks[c].domPre = counter++;
+			stack.emplace_back(c, 0);
+			continue;
+		}
+		blocks[b].domPost = counter++;
+		stack.pop_back();
+	}
+}
+
+// Headers are taken innermost first (a header comes after the headers that
+// dominate it in reverse postorder). Each loop's body is collected backwards
+// from its back edges; a block already claimed by an inner loop stands for
+// that whole loop, which gets the current loop as its parent.
+void findLoops(Cfg& cfg) {
+	std::vector<BasicBlock>& blocks = cfg.blocks;
+	std::vector<uint32_t> work;
+	// union-find over loops: the outermost loop found so far for each
+	std::vector<uint32_t> root;
+	auto outermost = [&](uint32_t l) {
+		uint32_t r = l;
+		while (root[r] != r) r = root[r];
+		while (root[l] != r) {
+			uint32_t next = root[l];
+			root[l] = r;
+			l = next;
+		}
+		return r;
+	};
+	for (size_t i = cfg.order.size(); i-- > 0;) {
+		uint32_t h = cfg.order[i];
+		work.clear();
+		for (uint32_t p : blocks[h].preds) {
+			if (cfg.reachable(p) && cfg.dominates(h, p)) work.push_back(p);
+		}
+		if (work.empty()) continue;
+
+		uint32_t l = static_cast<uint32_t>(cfg.loops.size());
+		Loop loop;
+		loop.header = h;
+		cfg.loops.push_back(loop);
+		root.push_back(l);
+		blocks[h].loop = l;
+		while (!work.empty()) {
+			uint32_t b = work.back();
+			work.pop_back();
+			if (blocks[b].loop == kNoLoop) {
+				blocks[b].loop = l;
+			} else {
+				uint32_t inner = outermost(blocks[b].loop);
+				if (inner == l) continue;
+				cfg.loops[inner].parent = l;
+				root[inner] = l;
+				b = cfg.loops[inner].header;
+			}
+			for (uint32_t p : blocks[b].preds) {
+				if (cfg.reachable(p)) work.push_back(p);
+			}
+		}
+	}
+	// parents are created after their children
+	for (size_t i = cfg.loops.size(); i-- > 0;) {
+		Loop& loop = cfg.loops[i];
+		loop.depth = loop.parent == kNoLoop ? 1 : cfg.loops[loop.parent].depth + 1;
+	}
+}
+
+} // namespace
+
+Cfg buildCfg(const TacFunction& fn) {
+	Cfg cfg;
+	splitBlocks(fn, cfg);
+	linkBlocks(fn, cfg);
+	std::vector<uint32_t> preorder, parent;
+	searchDepthFirst(cfg, preorder, parent);
+	computeDominators(cfg, preorder, parent);
+	findLoops(cfg);
+	return cfg;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Tac.hpp"
+
+#include <cstdint>
+#include <vector>
+
+constexpr uint32_t kNoBlock = ~0u;
+constexpr uint32_t kNoLoop = ~0u;
+
+// A maximal straight-line run of a function's code: it is entered only at
+// its first instruction and left only after its last.
+struct BasicBlock {
+	uint32_t begin = 0, end = 0;	// [begin, end) in TacFunction::code
+	std::vector<uint32_t> preds, succs;
+
+	// Unreachable blocks have rpo, idom and the dom numbers left at kNoBlock.
+	uint32_t rpo = kNoBlock;			// position in Cfg::order
+	uint32_t idom = kNoBlock;			// the entry block is its own idom
+	std::vector<uint32_t> domChildren;
+	uint32_t domPre = kNoBlock, domPost = kNoBlock;
+
+	uint32_t loop = kNoLoop;			// innermost loop containing the block
+};
+
+// A natural loop: the header and everything that reaches one of its back
+// edges without passing through the header.
+struct Loop {
+	uint32_t header = kNoBlock;
+	uint32_t parent = kNoLoop;	// the next enclosing loop
+	uint32_t depth = 1;			// 1 for an outermost loop
+};
+
+// Control-flow graph of one TacFunction. Blocks are numbered in code order
+// and block 0 is the entry. Building it is linear in the code size apart
+// from the dominator pass, which is O(E log V).
+//
+// The graph refers to the function by instruction index; rebuild it after
+// the code changes.
+struct Cfg {
+	std::vector<BasicBlock> blocks;
+	std::vector<uint32_t> order;	// reachable blocks in reverse postorder
+	std::vector<Loop> loops;		// inner loops before the loops enclosing them
+
+	bool reachable(uint32_t b) const { return blocks[b].rpo != kNoBlock; }
+	// a dominates b (every block dominates itself); false if either is unreachable
+	bool dominates(uint32_t a, uint32_t b) const {
+		const BasicBlock& x = blocks[a];
+		const BasicBlock& y = blocks[b];
+		return x.domPre != kNoBlock && y.domPre != kNoBlock &&
+			x.domPre <= y.domPre && y.domPost <= x.domPost;
+	}
+	uint32_t loopDepth(uint32_t b) const {
+		uint32_t l = blocks[b].loop;
+		return l == kNoLoop ? 0 : loops[l].depth;
+	}
+	// The block a Label operand starts, or kNoBlock if the function has no such label.
+	uint32_t blockOfLabel(uint32_t label) const {
+		uint32_t i = label - labelBase;
+		return i < labelBlocks.size() ? labelBlocks[i] : kNoBlock;
+	}
+
+	uint32_t labelBase = 0;
+	std::vector<uint32_t> labelBlocks;	// by label - labelBase
+};
+
+Cfg buildCfg(const TacFunction& fn);
+
+// True if control never continues to the next instruction.
+inline bool endsBlock(TacOp op) {
+	return op == TacOp::Goto || op == TacOp::IfGoto || op == TacOp::Return;
+}
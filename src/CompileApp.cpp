@@ -1,9 +1,81 @@
 #include "CompileApp.hpp"
+#include "AstSerializer.hpp"
 #include "windows.h"
 
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+// TokenʱLL(1)ÿTokenԼ5~6ԶڷĲޣ
+// Ҳڲ﷨ʼģ֤ -j Ч
+static constexpr size_t kMaxLL1TraceTokens=8*1024;
+
 void CompileApp::start(){
 	preprocessor.readTextFromIOManager(ioManager);
 	preprocessor.doPreprocess();
+
+	// ԤıδʱֱӸûASTʷ﷨
+	ProgramPtr ast;
+	const LineMap *lineMap=&cachedLineMap;
+	uint64_t sourceHash=hashSource(preprocessor.getText());
+	if(!cacheDir.empty()) ast=loadCachedAst(sourceHash);
+	if(ast){
+		ioManager.write("AST棬ʷ﷨\n");
+	}else{
+		ast=parseSource();
+		if(!ast) return;
+		lineMap=&lexer.getLineMap();
+		if(!cacheDir.empty()) storeCachedAst(*ast,sourceHash);
+	}
+	if(astFormat){
+		AstPrinter printer(*astFormat);
+		ioManager.write("﷨£\n");
+		ioManager.write(printer.print(*ast));
+	}
+
+	try{
+		semanticAnalyzer.setThreads(threads);
+		semanticAnalyzer.analyze(*ast);
+	}catch(const std::exception &e){
+		ioManager.write(std::string("")+e.what()+"\n");
+		return;
+	}
+	// һȫ󣬳޵Ĳг
+	const DiagnosticSink &diags=semanticAnalyzer.diagnostics();
+	if(!diags.empty()){
+		for(const Diagnostic &d : diags.diagnostics()){
+			ioManager.write(""+DiagnosticSink::format(d,lineMap)+"\n");
+		}
+		if(diags.full()){
+			ioManager.write("ﵽޣδг\n");
+		}
+		return;
+	}
+	ioManager.write("ɹ\n");
+
+	try{
+		TacModule tac = tacGenerator.build(*ast);
+		if(optimize){
+			size_t removed = optimizeTac(tac);
+			size_t left = 0;
+			for(const TacFunction &fn : tac.functions) left += fn.code.size();
+			ioManager.write("ַŻɾ"+std::to_string(removed)+"ָʣ"+std::to_string(left)+"\n");
+		}
+		ioManager.write("ַ£\n");
+		ioManager.write(printTac(tac));
+	}catch(const std::exception &e){
+		ioManager.write(std::string("ַɴ")+e.what()+"\n");
+		return;
+	}
+	
+
+
+
+	// system("pause");
+}
+
+ProgramPtr CompileApp::parseSource(){
 	lexer.setText(preprocessor.getText());
 	lexer.doLexer();
 	analysisResult.setTokens(lexer.getTokens());
@@ -19,51 +91,82 @@ void CompileApp::start(){
 	}
 	ioManager.write(LexerResult);
 
+	bool ll1Failed = false;
 	//  LL(1) Ԥչʾ֤
-	try {
+	// TokenвޣļֱӽAST﷨
+	if (lexer.getTokens().size() > kMaxLL1TraceTokens) {
+		ioManager.write("\nToken" + std::to_string(lexer.getTokens().size()) + ""
+			+ std::to_string(kMaxLL1TraceTokens) + "LL(1)Ԥ\n");
+	} else try {
 		auto ll1 = ll1TableParser.parseAndTrace(lexer.getTokens());
 		ioManager.write("\nLL(1)Ԥ£\n");
 		ioManager.write(ll1.trace);
 		if (!ll1.success) {
-			ioManager.write(std::string("\nLL(1)") + ll1.error + "\n");
-			return;
+			for (const auto& err : ll1.errors) {
+				ioManager.write(std::string("\nLL(1)") + err + "\n");
+			}
+			// AST﷨ָһгȫ﷨
+			ll1Failed = true;
+		} else {
+			ioManager.write("\nLL(1)ɹ\n");
 		}
-		ioManager.write("\nLL(1)ɹ\n");
 	} catch (const std::exception& e) {
 		ioManager.write(std::string("LL(1)ڲ") + e.what() + "\n");
-		return;
+		return nullptr;
 	}
 
 	ProgramPtr ast;
+	std::vector<ParseDiagnostic> parseDiags;
 	try{
-		parser.setTokens(lexer.getTokens());
-		ast=parser.parse();
+		if(threads>1){
+			ParallelParser parallelParser(threads);
+			ast=parallelParser.parse(lexer.getTokens());
+			parseDiags=parallelParser.diagnostics();
+		}else{
+			parser.setTokens(lexer.getTokens());
+			ast=parser.parse();
+			parseDiags=parser.diagnostics();
+		}
 	}catch(const std::exception &e){
 		ioManager.write(std::string("ڲASTʧܣ")+e.what()+"\n");
-		return;	
+		return nullptr;
 	}
-
-	try{
-		semanticAnalyzer.analyze(*ast);
-		ioManager.write("ɹ\n");
-	}catch(const std::exception &e){
-		ioManager.write(std::string("")+e.what()+"\n");
-		return;
+	if(!parseDiags.empty()){
+		for(const auto &d : parseDiags){
+			ioManager.write(std::string("ڲASTʧܣ")+d.toString()+"\n");
+		}
+		return nullptr;
 	}
+	if(ll1Failed) return nullptr;
+	return ast;
+}
 
+std::string CompileApp::cachePath(uint64_t sourceHash) const{
+	char name[32];
+	std::snprintf(name,sizeof(name),"%016llx.ast",static_cast<unsigned long long>(sourceHash));
+	return (std::filesystem::path(cacheDir)/name).string();
+}
+
+ProgramPtr CompileApp::loadCachedAst(uint64_t sourceHash){
+	std::ifstream ifs(cachePath(sourceHash),std::ios::in|std::ios::binary);
+	if(!ifs) return nullptr;
+	std::ostringstream ss;
+	ss<<ifs.rdbuf();
 	try{
-		std::string tac = tacGenerator.generate(*ast);
-		ioManager.write("ַ£\n");
-		ioManager.write(tac);
+		return deserializeProgram(ss.str(),sourceHash,cachedLineMap);
 	}catch(const std::exception &e){
-		ioManager.write(std::string("ַɴ")+e.what()+"\n");
-		return;
+		// ʱδУ·󸲸
+		ioManager.write(std::string("ASTЧ·")+e.what()+"\n");
+		return nullptr;
 	}
-	
-
-
+}
 
-	// system("pause");
+void CompileApp::storeCachedAst(const Program &ast,uint64_t sourceHash){
+	std::error_code ec;
+	std::filesystem::create_directories(cacheDir,ec);
+	std::ofstream ofs(cachePath(sourceHash),std::ios::out|std::ios::binary|std::ios::trunc);
+	if(ofs) ofs<<serializeProgram(ast,lexer.getLineMap(),sourceHash);
+	if(!ofs) ioManager.write("ASTдʧܣ"+cachePath(sourceHash)+"\n");
 }
 
 
@@ -6,7 +6,12 @@
 #include "Parser.hpp"
 #include "SemanticAnalyzer.hpp"
 #include "TACGenerator.hpp"
+#include "Optimizer.hpp"
 #include "LL1TableParser.hpp"
+#include "ParallelParser.hpp"
+#include "AstPrinter.hpp"
+
+#include <optional>
 
 
 class CompileApp{
@@ -19,8 +24,28 @@ class CompileApp{
 	LL1TableParser ll1TableParser;
 	SemanticAnalyzer semanticAnalyzer;
 	TACGenerator tacGenerator;
+	// ߳1ʱнм麯
+	unsigned threads=1;
+	// ASTĿ¼Ϊʱʹû
+	std::string cacheDir;
+	// ﷨󰴸øʽASTΪʱ
+	std::optional<AstFormat> astFormat;
+	// ǰǷŻַ
+	bool optimize=false;
+	// ӻASTӦб
+	LineMap cachedLineMap;
+
+	// ʷLL(1)﷨ʧʱ󲢷ؿ
+	ProgramPtr parseSource();
+	std::string cachePath(uint64_t sourceHash) const;
+	ProgramPtr loadCachedAst(uint64_t sourceHash);
+	void storeCachedAst(const Program &ast,uint64_t sourceHash);
 
 	public:
+	void setThreads(unsigned n){ threads=n; }
+	void setCacheDir(const std::string &dir){ cacheDir=dir; }
+	void setAstFormat(AstFormat format){ astFormat=format; }
+	void setOptimize(bool on){ optimize=on; }
 	void manu();
 	void start();
 	void run();
@@ -0,0 +1,558 @@
+#include "ConstProp.hpp"
+
+#include "Cfg.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+constexpr uint32_t kNone = ~0u;
+
+struct Value {
+	enum State : unsigned char { Top, Const, Bottom };
+	State state = Top;
+	Type type = Type::INT;
+	int64_t i = 0;		// INT and CHAR
+	double d = 0;		// DOUBLE
+
+	static Value bottom() {
+		Value v;
+		v.state = Bottom;
+		return v;
+	}
+	static Value integer(Type t, int64_t x) {
+		Value v;
+		v.state = Const;
+		v.type = t;
+		v.i = t == Type::CHAR ? static_cast<signed char>(x) : static_cast<int32_t>(x);
+		return v;
+	}
+	static Value real(double x) {
+		Value v;
+		v.state = Const;
+		v.type = Type::DOUBLE;
+		v.d = x;
+		return v;
+	}
+
+	bool isConst() const { return state == Const; }
+	double asDouble() const { return type == Type::DOUBLE ? d : static_cast<double>(i); }
+	bool truth() const { return type == Type::DOUBLE ? d != 0 : i != 0; }
+	bool same(const Value& o) const {
+		if (state != o.state) return false;
+		if (state != Const) return true;
+		if (type != o.type) return false;
+		return type == Type::DOUBLE ? std::memcmp(&d, &o.d, sizeof d) == 0 : i == o.i;
+	}
+};
+
+Value meet(const Value& a, const Value& b) {
+	if (a.state == Value::Top) return b;
+	if (b.state == Value::Top) return a;
+	if (a.same(b)) return a;
+	return Value::bottom();
+}
+
+// The value as the given type, by the char -> int -> double widening of
+// assignments (and truncation, should a narrowing ever get through).
+Value convert(const Value& v, Type to) {
+	if (!v.isConst() || v.type == to) return v;
+	switch (to) {
+		case Type::DOUBLE:
+			return Value::real(v.asDouble());
+		case Type::INT:
+		case Type::CHAR:
+			if (v.type == Type::DOUBLE) {
+				if (!(std::fabs(v.d) < 2147483648.0)) return Value::bottom();
+				return Value::integer(to, static_cast<int64_t>(v.d));
+			}
+			return Value::integer(to, v.i);
+		default:
+			return Value::bottom();
+	}
+}
+
+Value parseConst(const TacConst& c) {
+	const std::string& s = c.text;
+	switch (c.type) {
+		case Type::INT: {
+			errno = 0;
+			char* end = nullptr;
+			long long x = std::strtoll(s.c_str(), &end, 10);
+			if (errno || end == s.c_str() || *end || x > std::numeric_limits<int32_t>::max()) {
+				return Value::bottom();
+			}
+			return Value::integer(Type::INT, x);
+		}
+		case Type::DOUBLE: {
+			char* end = nullptr;
+			double x = std::strtod(s.c_str(), &end);
+			if (end == s.c_str() || *end) return Value::bottom();
+			return Value::real(x);
+		}
+		case Type::CHAR: {
+			// 'c' or '\c', as the lexer accepts them
+			if (s.size() == 3 && s[0] == '\'' && s[2] == '\'') {
+				return Value::integer(Type::CHAR, static_cast<unsigned char>(s[1]));
+			}
+			if (s.size() == 4 && s[0] == '\'' && s[1] == '\\' && s[3] == '\'') {
+				switch (s[2]) {
+					case 'n': return Value::integer(Type::CHAR, '\n');
+					case 't': return Value::integer(Type::CHAR, '\t');
+					case 'r': return Value::integer(Type::CHAR, '\r');
+					case '0': return Value::integer(Type::CHAR, 0);
+					default: return Value::integer(Type::CHAR, static_cast<unsigned char>(s[2]));
+				}
+			}
+			return Value::bottom();
+		}
+		default:
+			return Value::bottom();
+	}
+}
+
+// Source-like text for a folded constant.
+std::string constText(const Value& v) {
+	char buf[32];
+	switch (v.type) {
+		case Type::DOUBLE: {
+			std::snprintf(buf, sizeof buf, "%.17g", v.d);
+			std::string s = buf;
+			if (s.find_first_of(".e") == std::string::npos) s += ".0";
+			return s;
+		}
+		case Type::CHAR: {
+			int c = static_cast<int>(v.i);
+			switch (c) {
+				case '\n': return "'\\n'";
+				case '\t': return "'\\t'";
+				case '\r': return "'\\r'";
+				case 0: return "'\\0'";
+				case '\'': return "'\\''";
+				case '\\': return "'\\\\'";
+				default: break;
+			}
+			if (c >= 32 && c < 127) return std::string{'\'', static_cast<char>(c), '\''};
+			return std::to_string(c);
+		}
+		default:
+			return std::to_string(v.i);
+	}
+}
+
+Value foldBinary(TacOp op, const Value& a, const Value& b) {
+	// with both operands already computed, one constant side can decide && and ||
+	if (op == TacOp::And && ((a.isConst() && !a.truth()) || (b.isConst() && !b.truth()))) {
+		return Value::integer(Type::INT, 0);
+	}
+	if (op == TacOp::Or && ((a.isConst() && a.truth()) || (b.isConst() && b.truth()))) {
+		return Value::integer(Type::INT, 1);
+	}
+	if (a.state == Value::Bottom || b.state == Value::Bottom) return Value::bottom();
+	if (a.state == Value::Top || b.state == Value::Top) return Value();
+
+	switch (op) {
+		case TacOp::And: return Value::integer(Type::INT, a.truth() && b.truth());
+		case TacOp::Or: return Value::integer(Type::INT, a.truth() || b.truth());
+		default: break;
+	}
+	if (a.type == Type::DOUBLE || b.type == Type::DOUBLE) {
+		double x = a.asDouble(), y = b.asDouble();
+		double r;
+		switch (op) {
+			case TacOp::Add: r = x + y; break;
+			case TacOp::Sub: r = x - y; break;
+			case TacOp::Mul: r = x * y; break;
+			case TacOp::Div: r = x / y; break;
+			case TacOp::Lt: return Value::integer(Type::INT, x < y);
+			case TacOp::Gt: return Value::integer(Type::INT, x > y);
+			case TacOp::Le: return Value::integer(Type::INT, x <= y);
+			case TacOp::Ge: return Value::integer(Type::INT, x >= y);
+			case TacOp::Eq: return Value::integer(Type::INT, x == y);
+			case TacOp::Ne: return Value::integer(Type::INT, x != y);
+			default: return Value::bottom();
+		}
+		// no literal spells inf or nan
+		if (!std::isfinite(r)) return Value::bottom();
+		return Value::real(r);
+	}
+	int64_t x = a.i, y = b.i;
+	switch (op) {
+		case TacOp::Add: return Value::integer(Type::INT, x + y);
+		case TacOp::Sub: return Value::integer(Type::INT, x - y);
+		case TacOp::Mul: return Value::integer(Type::INT, static_cast<int64_t>(static_cast<uint64_t>(x) * static_cast<uint64_t>(y)));
+		case TacOp::Div:
+		case TacOp::Mod:
+			// leave traps to run time
+			if (y == 0 || (x == std::numeric_limits<int32_t>::min() && y == -1)) return Value::bottom();
+			return Value::integer(Type::INT, op == TacOp::Div ? x / y : x % y);
+		case TacOp::Lt: return Value::integer(Type::INT, x < y);
+		case TacOp::Gt: return Value::integer(Type::INT, x > y);
+		case TacOp::Le: return Value::integer(Type::INT, x <= y);
+		case TacOp::Ge: return Value::integer(Type::INT, x >= y);
+		case TacOp::Eq: return Value::integer(Type::INT, x == y);
+		case TacOp::Ne: return Value::integer(Type::INT, x != y);
+		default: return Value::bottom();
+	}
+}
+
+Value foldUnary(TacOp op, const Value& a) {
+	if (op == TacOp::Deref) return Value::bottom();
+	if (!a.isConst()) return a;
+	switch (op) {
+		case TacOp::Plus:
+			return a.type == Type::DOUBLE ? a : Value::integer(Type::INT, a.i);
+		case TacOp::Minus:
+			return a.type == Type::DOUBLE ? Value::real(-a.d) : Value::integer(Type::INT, -a.i);
+		case TacOp::Not:
+			return Value::integer(Type::INT, !a.truth());
+		default:
+			return Value::bottom();
+	}
+}
+
+bool readsA(TacOp op) {
+	return op != TacOp::Call && op != TacOp::Label && op != TacOp::Goto && op != TacOp::Unsupported;
+}
+
+// Keys to readers, as one array sliced by key.
+struct Readers {
+	std::vector<uint32_t> start, items;
+
+	void build(size_t keys, const std::vector<std::pair<uint32_t, uint32_t>>& pairs) {
+		start.assign(keys + 1, 0);
+		for (const auto& p : pairs) ++start[p.first + 1];
+		for (size_t k = 0; k < keys; ++k) start[k + 1] += start[k];
+		items.resize(pairs.size());
+		std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+		for (const auto& p : pairs) items[fill[p.first]++] = p.second;
+	}
+	template<class F>
+	void each(uint32_t key, F f) const {
+		for (uint32_t k = start[key]; k < start[key + 1]; ++k) f(items[k]);
+	}
+};
+
+class Propagator {
+public:
+	explicit Propagator(TacFunction& fn) : fn(fn), code(fn.code) {}
+	size_t run();
+
+private:
+	TacFunction& fn;
+	std::vector<TacInstr>& code;
+	Cfg cfg;
+
+	// Storage: temps first, then locals. Globals have none.
+	uint32_t tempBase = 0, tempCount = 0;
+	std::vector<Value> stored;
+	std::vector<Value> constants;	// parsed fn.consts
+	std::vector<Value> result;		// by instruction
+	std::vector<uint32_t> blockOf;
+	// per instruction, the definition earlier in its block that a and b read
+	std::vector<uint32_t> srcA, srcB;
+	Readers defReaders, storageReaders;
+	std::vector<char> executable;
+	std::vector<uint32_t> blockWork, instrWork;
+	std::vector<char> forced;		// IfGotos taken both ways by forceUndecided
+	bool opaque = false;			// has Unsupported placeholders
+
+	uint32_t storageOf(const TacOperand& o) const;
+	void link();
+	Value operandValue(const TacOperand& o, uint32_t src) const;
+	void visit(uint32_t i);
+	void reach(uint32_t block);
+	void leave(uint32_t block, uint32_t last);
+	bool forceUndecided();
+	size_t rewrite();
+	TacOperand constantOperand(const Value& v);
+};
+
+uint32_t Propagator::storageOf(const TacOperand& o) const {
+	if (o.kind == TacOperand::Kind::Temp) {
+		uint32_t k = o.id - tempBase;
+		return k < tempCount ? k : kNone;
+	}
+	if (o.kind == TacOperand::Kind::Var && isLocalSymbol(o.id)) {
+		return tempCount + symbolIndex(o.id);
+	}
+	return kNone;
+}
+
+// Finds, for each operand read, the definition before it in the same block
+// (none across a call for globals, none at all across an Unsupported
+// placeholder), and records who reads what.
+void Propagator::link() {
+	uint32_t n = static_cast<uint32_t>(code.size());
+	srcA.assign(n, kNone);
+	srcB.assign(n, kNone);
+	std::vector<std::pair<uint32_t, uint32_t>> byDef, byStorage;
+
+	std::vector<uint32_t> lastDef(stored.size(), kNone);
+	std::vector<uint32_t> touched;
+	// a block writes few globals; a table over all of them would cost every function
+	std::unordered_map<uint32_t, uint32_t> lastGlobal;
+	auto forgetGlobals = [&] { lastGlobal.clear(); };
+	auto forgetAll = [&] {
+		for (uint32_t s : touched) lastDef[s] = kNone;
+		touched.clear();
+		forgetGlobals();
+	};
+	auto read = [&](uint32_t i, const TacOperand& o, std::vector<uint32_t>& src) {
+		if (o.kind == TacOperand::Kind::Var && !isLocalSymbol(o.id)) {
+			auto it = lastGlobal.find(o.id);
+			src[i] = it == lastGlobal.end() ? kNone : it->second;
+		} else {
+			uint32_t s = storageOf(o);
+			if (s == kNone) return;
+			src[i] = lastDef[s];
+			if (src[i] == kNone) byStorage.emplace_back(s, i);
+		}
+		if (src[i] != kNone) byDef.emplace_back(src[i], i);
+	};
+
+	for (const BasicBlock& bb : cfg.blocks) {
+		forgetAll();
+		for (uint32_t i = bb.begin; i < bb.end; ++i) {
+			const TacInstr& in = code[i];
+			blockOf[i] = static_cast<uint32_t>(&bb - cfg.blocks.data());
+			if (readsA(in.op)) read(i, in.a, srcA);
+			if (isBinary(in.op)) read(i, in.b, srcB);
+
+			if (in.op == TacOp::Call) forgetGlobals();
+			if (in.op == TacOp::Unsupported) forgetAll();
+			if (in.dst.kind == TacOperand::Kind::Var && !isLocalSymbol(in.dst.id)) {
+				lastGlobal[in.dst.id] = i;
+			} else if (uint32_t s = storageOf(in.dst); s != kNone) {
+				if (lastDef[s] == kNone) touched.push_back(s);
+				lastDef[s] = i;
+			}
+		}
+	}
+	defReaders.build(n, byDef);
+	storageReaders.build(stored.size(), byStorage);
+}
+
+Value Propagator::operandValue(const TacOperand& o, uint32_t src) const {
+	if (src != kNone) return result[src];
+	switch (o.kind) {
+		case TacOperand::Kind::Const:
+			return constants[o.id];
+		case TacOperand::Kind::Temp:
+		case TacOperand::Kind::Var: {
+			uint32_t s = storageOf(o);
+			return s == kNone ? Value::bottom() : stored[s];
+		}
+		default:
+			return Value::bottom();
+	}
+}
+
+void Propagator::visit(uint32_t i) {
+	uint32_t b = blockOf[i];
+	if (!executable[b]) return;
+	const TacInstr& in = code[i];
+	Value v;
+	bool defines = true;
+	if (isBinary(in.op)) {
+		v = convert(foldBinary(in.op, operandValue(in.a, srcA[i]), operandValue(in.b, srcB[i])), in.type);
+	} else if (isUnary(in.op)) {
+		v = convert(foldUnary(in.op, operandValue(in.a, srcA[i])), in.type);
+	} else if (in.op == TacOp::Copy) {
+		v = convert(operandValue(in.a, srcA[i]), in.type);
+	} else if (in.op == TacOp::Call) {
+		v = Value::bottom();
+		defines = !in.dst.isNone();
+	} else {
+		defines = false;
+	}
+
+	if (defines) {
+		Value merged = meet(result[i], v);
+		if (!merged.same(result[i])) {
+			result[i] = merged;
+			defReaders.each(i, [&](uint32_t r) { instrWork.push_back(r); });
+			uint32_t s = storageOf(in.dst);
+			if (s != kNone) {
+				Value m = meet(stored[s], merged);
+				if (!m.same(stored[s])) {
+					stored[s] = m;
+					storageReaders.each(s, [&](uint32_t r) { instrWork.push_back(r); });
+				}
+			}
+		}
+	}
+	if (i + 1 == cfg.blocks[b].end) leave(b, i);
+}
+
+void Propagator::reach(uint32_t block) {
+	if (block == kNoBlock || executable[block]) return;
+	executable[block] = 1;
+	blockWork.push_back(block);
+}
+
+// Marks the successors the block's last instruction can take.
+void Propagator::leave(uint32_t b, uint32_t last) {
+	uint32_t next = b + 1 < cfg.blocks.size() ? b + 1 : kNoBlock;
+	if (last == kNone) {
+		reach(next);
+		return;
+	}
+	const TacInstr& in = code[last];
+	switch (in.op) {
+		case TacOp::Goto:
+			reach(cfg.blockOfLabel(in.a.id));
+			return;
+		case TacOp::Return:
+			return;
+		case TacOp::IfGoto: {
+			Value c = operandValue(in.a, srcA[last]);
+			if (forced[last]) c = Value::bottom();
+			if (c.state == Value::Top) return;
+			if (c.state == Value::Bottom || c.truth()) reach(cfg.blockOfLabel(in.b.id));
+			if (c.state == Value::Bottom || !c.truth()) reach(next);
+			return;
+		}
+		default:
+			reach(next);
+			return;
+	}
+}
+
+TacOperand Propagator::constantOperand(const Value& v) {
+	fn.consts.push_back(TacConst{v.type, constText(v)});
+	return TacOperand::constant(static_cast<uint32_t>(fn.consts.size() - 1));
+}
+
+size_t Propagator::run() {
+	cfg = buildCfg(fn);
+	uint32_t lo = ~0u, hi = 0;
+	for (const TacInstr& in : code) {
+		for (const TacOperand* o : {&in.dst, &in.a, &in.b}) {
+			if (o->kind == TacOperand::Kind::Temp) {
+				lo = std::min(lo, o->id);
+				hi = std::max(hi, o->id);
+			}
+		}
+		opaque = opaque || in.op == TacOp::Unsupported;
+	}
+	if (lo <= hi) {
+		tempBase = lo;
+		tempCount = hi - lo + 1;
+	}
+	stored.assign(tempCount + fn.localNames.size(), Value());
+	constants.reserve(fn.consts.size());
+	for (const TacConst& c : fn.consts) constants.push_back(parseConst(c));
+	result.assign(code.size(), Value());
+	blockOf.assign(code.size(), 0);
+	link();
+	// parameters arrive unknown, as does every local once a placeholder may have changed it
+	size_t unknown = opaque ? fn.localNames.size() : fn.paramCount;
+	for (size_t s = 0; s < unknown; ++s) stored[tempCount + s] = Value::bottom();
+
+	executable.assign(cfg.blocks.size(), 0);
+	forced.assign(code.size(), 0);
+	reach(0);
+	do {
+		while (!blockWork.empty() || !instrWork.empty()) {
+			if (!instrWork.empty()) {
+				uint32_t i = instrWork.back();
+				instrWork.pop_back();
+				visit(i);
+				continue;
+			}
+			uint32_t b = blockWork.back();
+			blockWork.pop_back();
+			const BasicBlock& bb = cfg.blocks[b];
+			if (bb.begin == bb.end) leave(b, kNone);
+			for (uint32_t i = bb.begin; i < bb.end; ++i) visit(i);
+		}
+	} while (forceUndecided());
+	return rewrite();
+}
+
+// A branch on a value nothing defines (an uninitialized local) decides
+// nothing during the search; once it is over, let it go both ways so that
+// the code after it survives.
+bool Propagator::forceUndecided() {
+	bool any = false;
+	for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+		const BasicBlock& bb = cfg.blocks[b];
+		if (!executable[b] || bb.begin == bb.end) continue;
+		uint32_t last = bb.end - 1;
+		if (code[last].op != TacOp::IfGoto || forced[last]) continue;
+		if (operandValue(code[last].a, srcA[last]).state != Value::Top) continue;
+		forced[last] = 1;
+		leave(b, last);
+		any = true;
+	}
+	return any;
+}
+
+size_t Propagator::rewrite() {
+	size_t before = code.size();
+	std::vector<char> keep(code.size(), 1);
+	for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+		const BasicBlock& bb = cfg.blocks[b];
+		for (uint32_t i = bb.begin; i < bb.end; ++i) {
+			if (!executable[b]) {
+				keep[i] = 0;
+				continue;
+			}
+			TacInstr& in = code[i];
+			Value cond;
+			if (in.op == TacOp::IfGoto) cond = operandValue(in.a, srcA[i]);
+			auto substitute = [&](TacOperand& o, uint32_t src) {
+				if (o.kind != TacOperand::Kind::Temp && o.kind != TacOperand::Kind::Var) return;
+				Value v = operandValue(o, src);
+				if (v.isConst()) o = constantOperand(v);
+			};
+			if (readsA(in.op)) substitute(in.a, srcA[i]);
+			if (isBinary(in.op)) substitute(in.b, srcB[i]);
+
+			bool pure = isBinary(in.op) || isUnary(in.op) || in.op == TacOp::Copy;
+			if (pure && result[i].isConst()) {
+				uint32_t s = storageOf(in.dst);
+				// every read of the temp has been replaced, provided all its definitions agree
+				if (in.dst.kind == TacOperand::Kind::Temp && s != kNone && stored[s].isConst()) {
+					keep[i] = 0;
+					continue;
+				}
+				if (in.op != TacOp::Copy || in.a.kind != TacOperand::Kind::Const) {
+					in.op = TacOp::Copy;
+					in.a = constantOperand(result[i]);
+					in.b = TacOperand();
+				}
+			}
+			if (in.op == TacOp::IfGoto && cond.isConst()) {
+				if (cond.truth()) {
+					in.op = TacOp::Goto;
+					in.a = in.b;
+					in.b = TacOperand();
+				} else {
+					keep[i] = 0;
+				}
+			}
+		}
+	}
+	size_t out = 0;
+	for (size_t i = 0; i < code.size(); ++i) {
+		if (keep[i]) code[out++] = code[i];
+	}
+	code.resize(out);
+	cleanUpJumps(fn);
+	return before - code.size();
+}
+
+} // namespace
+
+size_t propagateConstants(TacFunction& fn) {
+	return Propagator(fn).run();
+}
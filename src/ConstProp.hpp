@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Tac.hpp"
+
+#include <cstddef>
+
+// Sparse conditional constant propagation over one function's TAC.
+//
+// Values follow the semantic analyzer's arithmetic: char and int operands
+// compute in int, anything with a double in double, comparisons and logical
+// operators give int 0 or 1. Temps and locals are tracked; a read sees the
+// definition earlier in its block if there is one, otherwise every
+// definition in the reachable code. Globals are only forwarded within a
+// block, up to the next call.
+//
+// Afterwards constant operands are substituted, temps with a constant
+// value lose their definitions, branches on constants become gotos (or
+// disappear), and unreachable code is deleted along with jumps to the
+// next instruction and labels nothing jumps to.
+//
+// Returns the number of instructions removed.
+size_t propagateConstants(TacFunction& fn);
@@ -0,0 +1,240 @@
+#include "DeadCode.hpp"
+
+#include "Cfg.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t kNone = ~0u;
+
+bool readsA(TacOp op) {
+	return op != TacOp::Call && op != TacOp::Label && op != TacOp::Goto && op != TacOp::Unsupported;
+}
+
+bool removable(TacOp op) {
+	return ((isBinary(op) || isUnary(op)) && op != TacOp::Deref) || op == TacOp::Copy;
+}
+
+class Eliminator {
+public:
+	explicit Eliminator(TacFunction& fn) : fn(fn), code(fn.code) {}
+	size_t run();
+
+private:
+	TacFunction& fn;
+	std::vector<TacInstr>& code;
+	Cfg cfg;
+
+	// Storage: temps first, then locals. Globals are always live.
+	uint32_t tempBase = 0, tempCount = 0, storageCount = 0;
+	// Only names live across a block boundary get a bit in the block sets.
+	std::vector<uint32_t> bitOf;	// storage -> bit, or kNone
+	std::vector<uint32_t> names;	// bit -> storage
+	size_t words = 0;
+	std::vector<uint64_t> liveIn, liveOut, exposed, killed;	// blocks * words
+
+	uint32_t storageOf(const TacOperand& o) const;
+	size_t removeUnreachable();
+	void numberStorage();
+	void findGlobalNames();
+	void solve();
+	size_t sweep();
+
+	uint64_t* row(std::vector<uint64_t>& v, uint32_t b) { return v.data() + b * words; }
+};
+
+uint32_t Eliminator::storageOf(const TacOperand& o) const {
+	if (o.kind == TacOperand::Kind::Temp) {
+		uint32_t k = o.id - tempBase;
+		return k < tempCount ? k : kNone;
+	}
+	if (o.kind == TacOperand::Kind::Var && isLocalSymbol(o.id)) {
+		return tempCount + symbolIndex(o.id);
+	}
+	return kNone;
+}
+
+size_t Eliminator::removeUnreachable() {
+	size_t before = code.size();
+	size_t out = 0;
+	for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+		if (!cfg.reachable(b)) continue;
+		for (uint32_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; ++i) {
+			code[out++] = code[i];
+		}
+	}
+	code.resize(out);
+	if (out == before) return 0;
+	cleanUpJumps(fn);
+	return before - code.size();
+}
+
+void Eliminator::numberStorage() {
+	uint32_t lo = ~0u, hi = 0;
+	for (const TacInstr& in : code) {
+		for (const TacOperand* o : {&in.dst, &in.a, &in.b}) {
+			if (o->kind == TacOperand::Kind::Temp) {
+				lo = std::min(lo, o->id);
+				hi = std::max(hi, o->id);
+			}
+		}
+	}
+	tempBase = 0;
+	tempCount = 0;
+	if (lo <= hi) {
+		tempBase = lo;
+		tempCount = hi - lo + 1;
+	}
+	storageCount = tempCount + static_cast<uint32_t>(fn.localNames.size());
+}
+
+// Names read in some block before that block assigns them; everything
+// else lives and dies within one block and needs no bit.
+void Eliminator::findGlobalNames() {
+	bitOf.assign(storageCount, kNone);
+	names.clear();
+	std::vector<uint32_t> defined(storageCount, kNone);	// block that last assigned it
+	auto use = [&](uint32_t s, uint32_t b) {
+		if (s == kNone || defined[s] == b || bitOf[s] != kNone) return;
+		bitOf[s] = static_cast<uint32_t>(names.size());
+		names.push_back(s);
+	};
+	for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+		for (uint32_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; ++i) {
+			const TacInstr& in = code[i];
+			if (readsA(in.op)) use(storageOf(in.a), b);
+			if (isBinary(in.op)) use(storageOf(in.b), b);
+			if (in.op == TacOp::Unsupported) {
+				for (uint32_t s = tempCount; s < storageCount; ++s) use(s, b);
+			}
+			uint32_t d = storageOf(in.dst);
+			if (d != kNone) defined[d] = b;
+		}
+	}
+	words = (names.size() + 63) / 64;
+}
+
+void Eliminator::solve() {
+	size_t count = cfg.blocks.size();
+	liveIn.assign(count * words, 0);
+	liveOut.assign(count * words, 0);
+	exposed.assign(count * words, 0);
+	killed.assign(count * words, 0);
+	auto set = [](uint64_t* r, uint32_t bit) { r[bit / 64] |= uint64_t(1) << (bit % 64); };
+	auto has = [](const uint64_t* r, uint32_t bit) { return (r[bit / 64] >> (bit % 64)) & 1; };
+
+	for (uint32_t b : cfg.order) {
+		uint64_t* ue = row(exposed, b);
+		uint64_t* kill = row(killed, b);
+		auto use = [&](uint32_t s) {
+			if (s == kNone || bitOf[s] == kNone) return;
+			if (!has(kill, bitOf[s])) set(ue, bitOf[s]);
+		};
+		for (uint32_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; ++i) {
+			const TacInstr& in = code[i];
+			if (readsA(in.op)) use(storageOf(in.a));
+			if (isBinary(in.op)) use(storageOf(in.b));
+			if (in.op == TacOp::Unsupported) {
+				for (uint32_t s = tempCount; s < storageCount; ++s) use(s);
+			}
+			uint32_t d = storageOf(in.dst);
+			if (d != kNone && bitOf[d] != kNone) set(kill, bitOf[d]);
+		}
+	}
+
+	// postorder first, so a loop-free graph settles in one sweep
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (size_t k = cfg.order.size(); k-- > 0;) {
+			uint32_t b = cfg.order[k];
+			uint64_t* out = row(liveOut, b);
+			for (uint32_t s : cfg.blocks[b].succs) {
+				const uint64_t* in = row(liveIn, s);
+				for (size_t w = 0; w < words; ++w) out[w] |= in[w];
+			}
+			uint64_t* in = row(liveIn, b);
+			const uint64_t* ue = row(exposed, b);
+			const uint64_t* kill = row(killed, b);
+			for (size_t w = 0; w < words; ++w) {
+				uint64_t v = ue[w] | (out[w] & ~kill[w]);
+				if (v != in[w]) {
+					in[w] = v;
+					changed = true;
+				}
+			}
+		}
+	}
+}
+
+// Walks each block backwards from what is live at its end.
+size_t Eliminator::sweep() {
+	std::vector<char> keep(code.size(), 1);
+	std::vector<char> live(storageCount, 0);
+	std::vector<uint32_t> touched;
+	size_t removed = 0;
+	auto mark = [&](uint32_t s) {
+		if (s == kNone) return;
+		live[s] = 1;
+		touched.push_back(s);
+	};
+	for (uint32_t b : cfg.order) {
+		const uint64_t* out = row(liveOut, b);
+		for (uint32_t k = 0; k < names.size(); ++k) {
+			live[names[k]] = (out[k / 64] >> (k % 64)) & 1;
+		}
+		const BasicBlock& bb = cfg.blocks[b];
+		for (uint32_t i = bb.end; i-- > bb.begin;) {
+			TacInstr& in = code[i];
+			uint32_t d = storageOf(in.dst);
+			if (d != kNone && !live[d]) {
+				if (removable(in.op)) {
+					keep[i] = 0;
+					++removed;
+					continue;
+				}
+				if (in.op == TacOp::Call) in.dst = TacOperand();
+			}
+			if (d != kNone) live[d] = 0;
+			if (readsA(in.op)) mark(storageOf(in.a));
+			if (isBinary(in.op)) mark(storageOf(in.b));
+			if (in.op == TacOp::Unsupported) {
+				for (uint32_t s = tempCount; s < storageCount; ++s) mark(s);
+			}
+		}
+		for (uint32_t s : names) live[s] = 0;
+		for (uint32_t s : touched) live[s] = 0;
+		touched.clear();
+	}
+	if (removed) {
+		size_t out = 0;
+		for (size_t i = 0; i < code.size(); ++i) {
+			if (keep[i]) code[out++] = code[i];
+		}
+		code.resize(out);
+	}
+	return removed;
+}
+
+size_t Eliminator::run() {
+	cfg = buildCfg(fn);
+	size_t removed = removeUnreachable();
+	if (removed) cfg = buildCfg(fn);
+	for (;;) {
+		numberStorage();
+		findGlobalNames();
+		solve();
+		size_t dead = sweep();
+		if (!dead) break;
+		// an arm that lost all its code leaves jumps over nothing
+		removed += dead + cleanUpJumps(fn);
+		cfg = buildCfg(fn);
+	}
+	return removed;
+}
+
+} // namespace
+
+size_t eliminateDeadCode(TacFunction& fn) {
+	return Eliminator(fn).run();
+}
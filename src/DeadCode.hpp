@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Tac.hpp"
+
+#include <cstddef>
+
+// Dead code elimination over one function's TAC.
+//
+// Blocks that cannot be reached from the entry (code after a return, arms
+// of folded branches) are deleted first. Then a liveness analysis over the
+// CFG finds assignments to temps and locals whose value is never read
+// again; those are deleted, and calls whose result is unused keep the call
+// but lose the result. This repeats until nothing more dies, since removing
+// an instruction can kill the ones that fed it.
+//
+// Stores to globals, calls, parameters, returns and jumps always stay, as
+// does anything a while/for placeholder might read. Dead divisions go too,
+// divide by zero included.
+//
+// Returns the number of instructions removed.
+size_t eliminateDeadCode(TacFunction& fn);
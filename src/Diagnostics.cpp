@@ -0,0 +1,89 @@
+#include "Diagnostics.hpp"
+
+namespace {
+
+// Message templates, indexed by DiagCode
+const char* const kTemplates[] = {
+	"ظʶ: %0",
+	"ظ: %0",
+	"ظβ: %0",
+	"ʼͲ:  '%0' Ϊ %1, ʼʽΪ %2",
+	"if ȱʧ",
+	"if Ϊ void",
+	"while ȱʧ",
+	"while Ϊ void",
+	"for Ϊ void",
+	"return ֻܳں",
+	"void Ӧֵ",
+	" void 뷵ֵ",
+	"return Ͳƥ:  %0, ʵ %1",
+	"ֵʽ",
+	"ֵǱʶǰֵָ֧",
+	"ֵͲ:  %0, Ҳ %1",
+	"Ԫʽ",
+	"߼಻Ϊ void",
+	"ȽҪֵ",
+	"Ҫֵ",
+	"ȡģ㲻֧ double",
+	"һԪʽȱٲ",
+	"! 㲻֧ void",
+	"һԪ +/- Ҫֵ",
+	"δĺ: %0",
+	" '%0' ƥ:  %1, ʵ %2",
+	"Ϊ",
+	" '%0'  %1 Ͳƥ:  %2, ʵ %3",
+	"δıʶ: %0",
+	"ܵʹ: %0",
+};
+static_assert(sizeof(kTemplates) / sizeof(kTemplates[0]) == static_cast<size_t>(DiagCode::FunctionAsVariable) + 1,
+              "kTemplates must cover every DiagCode");
+
+} // namespace
+
+void DiagnosticSink::report(DiagCode code, const ASTNode& node, std::initializer_list<std::string> args) {
+	if (full()) {
+		return;
+	}
+	diags.push_back(Diagnostic{code, node.begin, node.end, std::vector<std::string>(args)});
+}
+
+void DiagnosticSink::add(Diagnostic d) {
+	if (full()) {
+		return;
+	}
+	diags.push_back(std::move(d));
+}
+
+std::vector<Diagnostic> DiagnosticSink::take() {
+	std::vector<Diagnostic> out;
+	out.swap(diags);
+	return out;
+}
+
+void DiagnosticSink::clear() {
+	diags.clear();
+}
+
+std::string DiagnosticSink::format(const Diagnostic& d, const LineMap* lines) {
+	std::string out;
+	if (lines && d.end > 0) {
+		SourceLoc loc = lines->locate(d.begin);
+		out += "( ";
+		out += std::to_string(loc.line);
+		out += ",  ";
+		out += std::to_string(loc.column);
+		out += "): ";
+	} else {
+		out += ": ";
+	}
+	for (const char* p = kTemplates[static_cast<size_t>(d.code)]; *p; ++p) {
+		size_t arg = static_cast<size_t>(p[1] - '0');
+		if (*p == '%' && arg < d.args.size()) {
+			out += d.args[arg];
+			++p;
+		} else {
+			out += *p;
+		}
+	}
+	return out;
+}
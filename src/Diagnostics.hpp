@@ -0,0 +1,82 @@
+#pragma once
+
+#include "AST.hpp"
+#include "LineMap.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Semantic error kinds; each has a message template in Diagnostics.cpp
+// with %0 to %3 standing for the arguments of the report.
+enum class DiagCode : unsigned char {
+	RedeclaredVar,			// %0 name
+	RedeclaredFunction,		// %0 name
+	RedeclaredParam,		// %0 name
+	InitTypeMismatch,		// %0 variable, %1 declared type, %2 initializer type
+	MissingIfCond,
+	VoidIfCond,
+	MissingWhileCond,
+	VoidWhileCond,
+	VoidForCond,
+	ReturnOutsideFunction,
+	ReturnValueInVoid,
+	MissingReturnValue,
+	ReturnTypeMismatch,		// %0 expected, %1 actual
+	IncompleteAssign,
+	AssignTargetNotVar,
+	AssignTypeMismatch,		// %0 left, %1 right
+	IncompleteBinary,
+	VoidLogicalOperand,
+	NonNumericCompare,
+	NonNumericArith,
+	DoubleModulo,
+	MissingOperand,
+	VoidNotOperand,
+	NonNumericSign,
+	UndeclaredFunction,		// %0 name
+	ArgCountMismatch,		// %0 function, %1 expected, %2 actual
+	NullArgument,
+	ArgTypeMismatch,		// %0 function, %1 position, %2 expected, %3 actual
+	UndeclaredIdentifier,	// %0 name
+	FunctionAsVariable,		// %0 name
+};
+
+// One recorded error: what went wrong, where, and the words to fill into
+// the message. Nothing is formatted until somebody asks for the text.
+struct Diagnostic {
+	DiagCode code;
+	uint32_t begin = 0;
+	uint32_t end = 0;	// 0 when the node carries no source range
+	std::vector<std::string> args;
+};
+
+// Collects diagnostics in report order. Once `limit` errors are kept,
+// further reports are dropped and full() tells the analyzer to stop.
+class DiagnosticSink {
+public:
+	static constexpr size_t kDefaultLimit = 100;
+
+	explicit DiagnosticSink(size_t limit = kDefaultLimit) : limit(limit) {}
+
+	void setLimit(size_t n) { limit = n; }
+	size_t errorLimit() const { return limit; }
+	void report(DiagCode code, const ASTNode& node, std::initializer_list<std::string> args = {});
+	void add(Diagnostic d);
+	// Moves the recorded diagnostics out, e.g. to merge several sinks in order.
+	std::vector<Diagnostic> take();
+	void clear();
+
+	bool full() const { return diags.size() >= limit; }
+	bool empty() const { return diags.empty(); }
+	const std::vector<Diagnostic>& diagnostics() const { return diags; }
+
+	// "( L,  C): message", or without the location when there
+	// is no line map or the node has no range.
+	static std::string format(const Diagnostic& d, const LineMap* lines);
+
+private:
+	std::vector<Diagnostic> diags;
+	size_t limit;
+};
@@ -0,0 +1,388 @@
+#include "IncrementalParser.hpp"
+#include "Lexer.hpp"
+#include "ParallelParser.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Same normalisation the Preprocessor applies to a whole file.
+std::string normalize(const std::string& text) {
+	std::string out;
+	out.reserve(text.size());
+	for (char c : text) {
+		if (c == '\r') continue;
+		out += c == '\t' ? ' ' : c;
+	}
+	return out;
+}
+
+// Replaces v[at, at + count) with the elements of repl. Overlapping slots
+// are move-assigned, so the usual one-for-one replacement does not shift
+// the rest of a long vector.
+template<class Vec, class Repl>
+void spliceRange(Vec& v, size_t at, size_t count, Repl& repl) {
+	size_t common = std::min(count, repl.size());
+	std::move(repl.begin(), repl.begin() + common, v.begin() + at);
+	if (repl.size() > common) {
+		v.insert(v.begin() + at + common, std::make_move_iterator(repl.begin() + common),
+		         std::make_move_iterator(repl.end()));
+	} else {
+		v.erase(v.begin() + at + common, v.begin() + at + count);
+	}
+}
+
+void shiftNodes(ASTNode* n, int64_t delta);
+
+template<class T>
+void shiftList(NodeList<T>& list, int64_t delta) {
+	for (auto& n : list) shiftNodes(n.get(), delta);
+}
+
+// Moves the source ranges of a subtree by delta bytes.
+void shiftNodes(ASTNode* n, int64_t delta) {
+	if (!n) return;
+	if (n->end > 0) {
+		n->begin = static_cast<uint32_t>(n->begin + delta);
+		n->end = static_cast<uint32_t>(n->end + delta);
+	}
+	switch (n->kind) {
+		case NodeKind::Program: shiftList(static_cast<Program*>(n)->decls, delta); break;
+		case NodeKind::VarDecl: shiftNodes(static_cast<VarDecl*>(n)->init.get(), delta); break;
+		case NodeKind::FunDecl: {
+			auto* f = static_cast<FunDecl*>(n);
+			shiftList(f->params, delta);
+			shiftNodes(f->body.get(), delta);
+			break;
+		}
+		case NodeKind::Param: break;
+		case NodeKind::CompoundStmt: {
+			auto* c = static_cast<CompoundStmt*>(n);
+			shiftList(c->localVars, delta);
+			shiftList(c->stmts, delta);
+			break;
+		}
+		case NodeKind::IfStmt: {
+			auto* s = static_cast<IfStmt*>(n);
+			shiftNodes(s->cond.get(), delta);
+			shiftNodes(s->thenBranch.get(), delta);
+			shiftNodes(s->elseBranch.get(), delta);
+			break;
+		}
+		case NodeKind::WhileStmt: {
+			auto* s = static_cast<WhileStmt*>(n);
+			shiftNodes(s->cond.get(), delta);
+			shiftNodes(s->body.get(), delta);
+			break;
+		}
+		case NodeKind::ForStmt: {
+			auto* s = static_cast<ForStmt*>(n);
+			shiftNodes(s->init.get(), delta);
+			shiftNodes(s->cond.get(), delta);
+			shiftNodes(s->update.get(), delta);
+			shiftNodes(s->body.get(), delta);
+			break;
+		}
+		case NodeKind::ReturnStmt: shiftNodes(static_cast<ReturnStmt*>(n)->expr.get(), delta); break;
+		case NodeKind::ExprStmt: shiftNodes(static_cast<ExprStmt*>(n)->expr.get(), delta); break;
+		case NodeKind::IntLiteral:
+		case NodeKind::CharLiteral:
+		case NodeKind::DoubleLiteral:
+		case NodeKind::ValExpr: break;
+		case NodeKind::AssignExpr: {
+			auto* e = static_cast<AssignExpr*>(n);
+			shiftNodes(e->left.get(), delta);
+			shiftNodes(e->right.get(), delta);
+			break;
+		}
+		case NodeKind::BinaryExpr: {
+			auto* e = static_cast<BinaryExpr*>(n);
+			shiftNodes(e->left.get(), delta);
+			shiftNodes(e->right.get(), delta);
+			break;
+		}
+		case NodeKind::UnaryExpr: shiftNodes(static_cast<UnaryExpr*>(n)->operand.get(), delta); break;
+		case NodeKind::CallExpr: shiftList(static_cast<CallExpr*>(n)->args, delta); break;
+	}
+}
+
+} // namespace
+
+void IncrementalParser::CountTree::build(const std::vector<Segment>& segments) {
+	size_t n = segments.size();
+	tree.assign(n + 1, Counts{});
+	for (size_t i = 1; i <= n; ++i) {
+		tree[i] += countsOf(segments[i - 1]);
+		size_t parent = i + (i & (0 - i));
+		if (parent <= n) tree[parent] += tree[i];
+	}
+	top = n > 0 ? 1 : 0;
+	while (top * 2 <= n) top *= 2;
+}
+
+void IncrementalParser::CountTree::add(size_t i, const Counts& delta) {
+	for (size_t k = i + 1; k < tree.size(); k += k & (0 - k)) tree[k] += delta;
+}
+
+IncrementalParser::Counts IncrementalParser::CountTree::prefix(size_t k) const {
+	Counts sum;
+	for (; k > 0; k -= k & (0 - k)) sum += tree[k];
+	return sum;
+}
+
+size_t IncrementalParser::CountTree::find(uint32_t Counts::*field, uint32_t value) const {
+	size_t pos = 0;
+	for (size_t step = top; step > 0; step >>= 1) {
+		if (pos + step < tree.size() && tree[pos + step].*field <= value) {
+			pos += step;
+			value -= tree[pos].*field;
+		}
+	}
+	return std::min(pos, size() - 1);
+}
+
+IncrementalParser::Counts IncrementalParser::countsOf(const Segment& seg) {
+	return Counts{seg.length, static_cast<uint32_t>(seg.lineStarts.size()), seg.declCount};
+}
+
+IncrementalParser::IncrementalParser(ProgramPtr program, const std::vector<Token>& tokens, const LineMap& lineMap)
+	: prog(std::move(program)) {
+	std::vector<Token> toks(tokens);
+	uint32_t size = 0;
+	if (!toks.empty() && toks.back().type == TokenType::Eof) {
+		size = toks.back().offset;
+		toks.pop_back();
+	} else if (!toks.empty()) {
+		size = toks.back().offset + static_cast<uint32_t>(toks.back().lexeme.size());
+	}
+	std::vector<uint32_t> starts;
+	for (size_t i = 1; i < lineMap.lineCount(); ++i) starts.push_back(lineMap.lineStart(i));
+	bool aligned = ParallelParser::findTopLevelDecls(toks).size() == prog->decls.size();
+	addSegments(segments, toks, 0, size, SourceLoc{1, 1}, starts, prog->decls.size(), aligned);
+	counts.build(segments);
+	staleFrom = segments.size();
+}
+
+void IncrementalParser::addSegments(std::vector<Segment>& out, std::vector<Token>& toks, uint32_t base,
+                                    uint32_t size, SourceLoc baseLoc, const std::vector<uint32_t>& lineStarts,
+                                    size_t declCount, bool splitPerDecl) {
+	// token ranges of the segments; the first starts at base, the others at
+	// their first token, and each runs up to the next
+	std::vector<DeclSpan> spans;
+	if (toks.empty()) {
+		spans.push_back(DeclSpan{0, 0});
+	} else if (!splitPerDecl) {
+		// the declarations do not line up with the brace scan (syntax errors):
+		// keep the tokens together so the next edit reparses all of them
+		spans.push_back(DeclSpan{0, toks.size()});
+	} else {
+		spans = ParallelParser::findTopLevelDecls(toks);
+	}
+
+	auto nextStart = lineStarts.begin();
+	for (size_t k = 0; k < spans.size(); ++k) {
+		const DeclSpan& span = spans[k];
+		Segment seg;
+		uint32_t start = k == 0 ? base : toks[span.begin].offset;
+		uint32_t end = k + 1 < spans.size() ? toks[spans[k + 1].begin].offset : base + size;
+		SourceLoc loc = k == 0 ? baseLoc : SourceLoc{toks[span.begin].line, toks[span.begin].column};
+		seg.length = end - start;
+		seg.nodeOffset = start;
+		seg.declCount = static_cast<uint32_t>(toks.empty() ? 0 : splitPerDecl ? 1 : declCount);
+		for (; nextStart != lineStarts.end() && *nextStart <= end; ++nextStart) {
+			if (*nextStart > start) seg.lineStarts.push_back(*nextStart - start);
+		}
+		seg.tokens.assign(std::make_move_iterator(toks.begin() + span.begin),
+		                  std::make_move_iterator(toks.begin() + span.end));
+		for (Token& t : seg.tokens) {
+			t.line -= loc.line;
+			if (t.line == 0) t.column -= loc.column;
+			t.offset -= start;
+		}
+		out.push_back(std::move(seg));
+	}
+}
+
+uint32_t IncrementalParser::lineStart(int line) const {
+	uint32_t total = counts.prefix(counts.size()).lines;
+	if (line <= 1) return 0;
+	// line L starts after the (L - 1)th '\n'
+	uint32_t newline = std::min(static_cast<uint32_t>(line - 1), total);
+	if (newline == 0) return 0;
+	size_t k = counts.find(&Counts::lines, newline - 1);
+	Counts before = counts.prefix(k);
+	return before.bytes + segments[k].lineStarts[newline - 1 - before.lines];
+}
+
+SourceLoc IncrementalParser::locate(uint32_t offset) const {
+	size_t k = counts.find(&Counts::bytes, offset);
+	Counts before = counts.prefix(k);
+	const std::vector<uint32_t>& starts = segments[k].lineStarts;
+	size_t inside = std::upper_bound(starts.begin(), starts.end(), offset - before.bytes) - starts.begin();
+	int line = static_cast<int>(1 + before.lines + inside);
+	uint32_t begin = inside > 0 ? before.bytes + starts[inside - 1] : lineStart(line);
+	return SourceLoc{line, static_cast<int>(offset - begin + 1)};
+}
+
+uint32_t IncrementalParser::offsetOf(int line, int column) const {
+	return std::min(lineStart(line) + static_cast<uint32_t>(std::max(column, 1) - 1), textSize());
+}
+
+// The lexer only separates tokens with ' ' and '\n', so the text of a
+// segment is its tokens over a run of spaces with the line breaks put back.
+void IncrementalParser::appendText(std::string& out, size_t i) const {
+	const Segment& seg = segments[i];
+	size_t at = out.size();
+	out.append(seg.length, ' ');
+	for (uint32_t p : seg.lineStarts) out[at + p - 1] = '\n';
+	for (const Token& t : seg.tokens) std::copy(t.lexeme.begin(), t.lexeme.end(), out.begin() + at + t.offset);
+}
+
+LineMap IncrementalParser::lineMap() const {
+	LineMap map;
+	uint32_t start = 0;
+	for (const Segment& seg : segments) {
+		for (uint32_t p : seg.lineStarts) map.addLineStart(start + p);
+		start += seg.length;
+	}
+	return map;
+}
+
+std::vector<Token> IncrementalParser::tokens() const {
+	std::vector<Token> out;
+	uint32_t start = 0;
+	uint32_t currentLineStart = 0;
+	int line = 1;
+	for (const Segment& seg : segments) {
+		int column = static_cast<int>(start - currentLineStart + 1);
+		for (const Token& t : seg.tokens) {
+			Token a = t;
+			if (t.line == 0) a.column += column;
+			a.line += line;
+			a.offset += start;
+			out.push_back(std::move(a));
+		}
+		line += static_cast<int>(seg.lineStarts.size());
+		if (!seg.lineStarts.empty()) currentLineStart = start + seg.lineStarts.back();
+		start += seg.length;
+	}
+	out.push_back(Token(TokenType::Eof, line, static_cast<int>(start - currentLineStart + 1), ""));
+	out.back().offset = start;
+	return out;
+}
+
+Program& IncrementalParser::program() {
+	// catch up on the shifts applyEdit left pending
+	if (staleFrom < segments.size()) {
+		Counts before = counts.prefix(staleFrom);
+		uint32_t start = before.bytes;
+		size_t d = before.decls;
+		for (size_t i = staleFrom; i < segments.size(); ++i) {
+			Segment& seg = segments[i];
+			if (seg.nodeOffset != start) {
+				int64_t delta = static_cast<int64_t>(start) - static_cast<int64_t>(seg.nodeOffset);
+				for (size_t j = d; j < d + seg.declCount; ++j) shiftNodes(prog->decls[j].get(), delta);
+				seg.nodeOffset = start;
+			}
+			d += seg.declCount;
+			start += seg.length;
+		}
+		staleFrom = segments.size();
+	}
+	// the program ends with its last token, as Parser::parse leaves it
+	prog->end = 0;
+	for (size_t i = segments.size(); i-- > 0;) {
+		if (!segments[i].tokens.empty()) {
+			const Token& last = segments[i].tokens.back();
+			prog->end = counts.prefix(i).bytes + last.offset + static_cast<uint32_t>(last.lexeme.size());
+			break;
+		}
+	}
+	return *prog;
+}
+
+ReparseResult IncrementalParser::applyEdit(const TextEdit& edit) {
+	ReparseResult result;
+	uint32_t a = offsetOf(edit.beginLine, edit.beginColumn);
+	uint32_t b = offsetOf(edit.endLine, edit.endColumn);
+	if (b < a) std::swap(a, b);
+
+	// Segments [r0, r1] are replaced by the reparse of their text with the
+	// edit applied. They include the characters on either side of the edit,
+	// since text typed right against a token may join it.
+	size_t r0 = counts.find(&Counts::bytes, a > 0 ? a - 1 : 0);
+	size_t r1 = counts.find(&Counts::bytes, b);
+	Counts before = counts.prefix(r0);
+	Counts through = counts.prefix(r1 + 1);
+	uint32_t base = before.bytes;
+	SourceLoc baseLoc = locate(base);
+
+	std::string text;
+	text.reserve(through.bytes - base);
+	for (size_t i = r0; i <= r1; ++i) appendText(text, i);
+	size_t oldSize = text.size();
+	text.replace(a - base, b - a, normalize(edit.newText));
+	int64_t delta = static_cast<int64_t>(text.size()) - static_cast<int64_t>(oldSize);
+
+	Lexer lexer;
+	lexer.setText(text);
+	lexer.doLexer();
+	std::vector<Token> newTokens = lexer.getTokens();
+	// the lexer counts from 1:1; move the tokens to where the text starts
+	for (Token& t : newTokens) {
+		if (t.line == 1) t.column += baseLoc.column - 1;
+		t.line += baseLoc.line - 1;
+		t.offset += base;
+	}
+
+	Parser parser;
+	parser.setTokens(newTokens);
+	ProgramPtr part = parser.parse();
+	result.diagnostics = parser.diagnostics();
+	newTokens.pop_back();	// Eof
+	result.reparsedTokens = newTokens.size();
+
+	std::vector<uint32_t> starts;
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (text[i] == '\n') starts.push_back(base + static_cast<uint32_t>(i) + 1);
+	}
+	std::vector<Segment> newSegments;
+	bool aligned = !parser.hasErrors() && ParallelParser::findTopLevelDecls(newTokens).size() == part->decls.size();
+	addSegments(newSegments, newTokens, base, static_cast<uint32_t>(text.size()), baseLoc, starts,
+	            part->decls.size(), aligned);
+
+	// Fewer segments than before are padded with empty ones, so the counts
+	// take point updates and the later segments stay where they are.
+	size_t oldCount = r1 - r0 + 1;
+	while (newSegments.size() < oldCount) {
+		Segment empty;
+		empty.nodeOffset = base + static_cast<uint32_t>(text.size());
+		newSegments.push_back(std::move(empty));
+	}
+	size_t newCount = newSegments.size();
+	if (newCount == oldCount) {
+		for (size_t j = 0; j < oldCount; ++j) {
+			counts.add(r0 + j, countsOf(newSegments[j]) - countsOf(segments[r0 + j]));
+		}
+	}
+	spliceRange(segments, r0, oldCount, newSegments);
+	if (newCount != oldCount) counts.build(segments);
+
+	// node ranges behind the edit are moved later, in program()
+	size_t after = r0 + newCount;
+	if (staleFrom > r1) staleFrom = staleFrom - oldCount + newCount;
+	else if (staleFrom >= r0) staleFrom = after;
+	if (delta != 0) staleFrom = std::min(staleFrom, after);
+
+	size_t d0 = before.decls;
+	size_t removed = through.decls - before.decls;
+	spliceRange(prog->decls, d0, removed, part->decls);
+	prog->adoptedArenas.push_back(std::move(part->arena));
+	for (auto& arena : part->adoptedArenas) prog->adoptedArenas.push_back(std::move(arena));
+
+	result.firstDecl = d0;
+	result.removedDecls = removed;
+	result.insertedDecls = part->decls.size();
+	return result;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "AST.hpp"
+#include "LineMap.hpp"
+#include "Parser.hpp"
+#include "Token.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Replaces the text in [begin, end) of the current source with newText.
+// Positions are 1-based line/column as in Token; begin == end inserts.
+struct TextEdit {
+	int beginLine = 1;
+	int beginColumn = 1;
+	int endLine = 1;
+	int endColumn = 1;
+	std::string newText;
+};
+
+struct ReparseResult {
+	size_t firstDecl = 0;		// index in Program::decls of the first replaced declaration
+	size_t removedDecls = 0;	// declarations dropped from the old tree
+	size_t insertedDecls = 0;	// declarations parsed from the edited text
+	size_t reparsedTokens = 0;	// tokens lexed and parsed for this edit
+	std::vector<ParseDiagnostic> diagnostics;
+};
+
+// Keeps a parsed program up to date under text edits, for editor use.
+//
+// The text is held as a run of segments, each covering one top-level
+// declaration and the blanks after it, with its tokens and line starts
+// stored relative to the segment start (the source itself is not kept).
+// Byte, line and declaration counts per segment sit in Fenwick trees, so
+// finding the segments an edit touches, and where they start, takes
+// O(log n). An edit rebuilds the text of those segments from their tokens,
+// re-lexes and reparses only that, and updates their counts; segments
+// after it are not visited, and every other declaration subtree is reused
+// untouched. An edit that leaves the number of segments as it was costs
+// the size of the declarations it touches plus O(log n). One that adds
+// segments also moves the later entries of the segment and declaration
+// arrays and rebuilds the counts, which is linear in the number of
+// declarations but no longer in the text.
+//
+// The node ranges of declarations after an edit go stale; program() brings
+// them up to date, which costs the size of every declaration behind the
+// earliest edit since the previous call.
+//
+// New nodes live in arenas the Program adopts. Replaced nodes are destroyed,
+// but their arena memory is only released with the Program; reparse from
+// scratch now and then if a session makes very many edits.
+class IncrementalParser {
+public:
+	// prog must be the result of parsing tokens (which end in Eof);
+	// lineMap is the one the Lexer built for them
+	IncrementalParser(ProgramPtr prog, const std::vector<Token>& tokens, const LineMap& lineMap);
+
+	ReparseResult applyEdit(const TextEdit& edit);
+
+	Program& program();
+	// These rebuild their result from every segment.
+	LineMap lineMap() const;
+	// the current token stream with absolute positions, ending in Eof
+	std::vector<Token> tokens() const;
+
+private:
+	// The text [start, start + length) of a segment, where start is the sum
+	// of the lengths before it. Token lines are relative to the segment's
+	// first line; columns are relative to the start column on that line
+	// only; offsets are relative to start.
+	struct Segment {
+		uint32_t length = 0;
+		std::vector<uint32_t> lineStarts;	// after each '\n' in the segment, relative to start
+		std::vector<Token> tokens;
+		uint32_t declCount = 0;		// Program::decls entries parsed from it
+		uint32_t nodeOffset = 0;	// start when its node ranges were last moved
+	};
+
+	struct Counts {
+		uint32_t bytes = 0;
+		uint32_t lines = 0;		// '\n' characters
+		uint32_t decls = 0;
+
+		Counts& operator+=(const Counts& o) {
+			bytes += o.bytes;
+			lines += o.lines;
+			decls += o.decls;
+			return *this;
+		}
+		Counts operator-(const Counts& o) const { return Counts{bytes - o.bytes, lines - o.lines, decls - o.decls}; }
+	};
+
+	// Fenwick tree over the segments' Counts. Sums wrap like uint32_t, so
+	// an update adds the difference of two counts.
+	class CountTree {
+	public:
+		void build(const std::vector<Segment>& segments);
+		void add(size_t i, const Counts& delta);
+		// sum over segments [0, k)
+		Counts prefix(size_t k) const;
+		// largest k whose prefix(k).*field <= value, at most size() - 1
+		size_t find(uint32_t Counts::*field, uint32_t value) const;
+		size_t size() const { return tree.size() - 1; }
+
+	private:
+		std::vector<Counts> tree{Counts{}};	// 1-based
+		size_t top = 0;						// highest power of two <= size()
+	};
+
+	ProgramPtr prog;
+	std::vector<Segment> segments;	// never empty
+	CountTree counts;
+	size_t staleFrom = 0;	// segments from here on may have moved nodes
+
+	static Counts countsOf(const Segment& seg);
+	uint32_t textSize() const { return counts.prefix(counts.size()).bytes; }
+	uint32_t lineStart(int line) const;
+	SourceLoc locate(uint32_t offset) const;
+	uint32_t offsetOf(int line, int column) const;
+	void appendText(std::string& out, size_t i) const;
+	// Splits the text [base, base + size), which starts at baseLoc, into
+	// segments; toks and lineStarts are its tokens and line starts with
+	// absolute positions.
+	static void addSegments(std::vector<Segment>& out, std::vector<Token>& toks, uint32_t base, uint32_t size,
+	                        SourceLoc baseLoc, const std::vector<uint32_t>& lineStarts, size_t declCount,
+	                        bool splitPerDecl);
+};
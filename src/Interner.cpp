@@ -0,0 +1,40 @@
+#include "Interner.hpp"
+
+#include <mutex>
+
+NameId Interner::intern(std::string_view s) {
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto it = ids.find(s);
+		if (it != ids.end()) return it->second;
+	}
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	// another thread may have added it between the two locks
+	auto it = ids.find(s);
+	if (it != ids.end()) return it->second;
+	NameId id = static_cast<NameId>(names.size());
+	names.emplace_back(s);
+	ids.emplace(names.back(), id);
+	return id;
+}
+
+NameId Interner::find(std::string_view s) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	auto it = ids.find(s);
+	return it == ids.end() ? kNoName : it->second;
+}
+
+const std::string& Interner::name(NameId id) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	return names[id];
+}
+
+size_t Interner::size() const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	return names.size();
+}
+
+Interner& identifiers() {
+	static Interner table;
+	return table;
+}
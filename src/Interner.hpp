@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Dense id of an interned identifier
+using NameId = uint32_t;
+constexpr NameId kNoName = 0xFFFFFFFFu;
+
+// Maps identifier spellings to dense ids, so later passes compare and index
+// names by integer. Ids are never reused or freed. Safe to call from several
+// threads (ParallelParser interns from every worker); looking up a known
+// name only takes a shared lock.
+class Interner {
+public:
+	NameId intern(std::string_view s);
+	// kNoName if s was never interned
+	NameId find(std::string_view s) const;
+	const std::string& name(NameId id) const;
+	size_t size() const;
+
+private:
+	mutable std::shared_mutex mutex;
+	std::deque<std::string> names;	// deque: growing keeps the keys' storage in place
+	std::unordered_map<std::string_view, NameId> ids;
+};
+
+// The process-wide identifier table shared by the parsers and the symbol table.
+Interner& identifiers();
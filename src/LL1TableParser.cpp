@@ -395,13 +395,47 @@ void LL1TableParser::buildParseTableOrThrow() {
 	}
 }
 
-LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& tokens) const {
+int LL1TableParser::lookupProduction(NT nt, TokenType lookahead) const {
+	auto rowIt = table.find(nti(nt));
+	if (rowIt == table.end()) return -1;
+	auto cellIt = rowIt->second.find(lookahead);
+	if (cellIt == rowIt->second.end()) return -1;
+	return cellIt->second;
+}
+
+bool LL1TableParser::inFollow(NT nt, TokenType t) const {
+	auto it = follow.find(nti(nt));
+	return it != follow.end() && it->second.count(t) != 0;
+}
+
+bool LL1TableParser::isSyncToken(TokenType t) {
+	switch (t) {
+		// statement / block terminators
+		case TokenType::Semicolon:
+		case TokenType::RBrace:
+		// tokens that can only start a new statement or declaration
+		case TokenType::kw_if:
+		case TokenType::kw_while:
+		case TokenType::kw_for:
+		case TokenType::kw_return:
+		case TokenType::kw_int:
+		case TokenType::kw_char:
+		case TokenType::kw_void:
+		case TokenType::kw_double:
+			return true;
+		default:
+			return false;
+	}
+}
+
+LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& tokens, size_t maxErrors) const {
 	Result r;
 	std::ostringstream out;
 
 	if (tokens.empty()) {
 		r.success = false;
 		r.error = "LL1TableParser: empty token stream";
+		r.errors.push_back(r.error);
 		return r;
 	}
 
@@ -410,11 +444,35 @@ LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& t
 	st.push_back(T(TokenType::Eof));
 	st.push_back(N(NT::Program));
 
+	// Errors raised before any terminal has been matched since the previous
+	// error are cascades of it, so only the first of them is reported.
+	bool recovering = false;
+	auto reportError = [&](const std::string& msg) {
+		if (recovering) return;
+		recovering = true;
+		if (r.errors.empty()) r.error = msg;
+		r.errors.push_back(msg);
+	};
+	auto finish = [&](bool accepted) {
+		r.success = accepted && r.errors.empty();
+		r.trace = out.str();
+		return r;
+	};
+	// Eof is never consumed, so pos always stays on a valid token.
+	auto skipToken = [&]() {
+		out << "\t\t\trecover: skip " << tokenShort(tokens[pos]) << "\n";
+		pos++;
+	};
+
 	out << "Step\tStack\tInput\tAction\n";
 	out << "----\t-----\t-----\t------\n";
 
 	for (int step = 1; step <= 200000; step++) {
 		if (st.empty()) break;
+		if (maxErrors > 0 && r.errors.size() >= maxErrors) {
+			out << "too many errors, giving up\n";
+			return finish(false);
+		}
 
 		TokenType lookahead = tokens[pos].type;
 		const Sym X = st.back();
@@ -425,13 +483,12 @@ LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& t
 			if (X.term == lookahead) {
 				out << "match " << tokenTypeShort(lookahead) << "\n";
 				st.pop_back();
+				recovering = false;
 				if (lookahead != TokenType::Eof) pos++;
 				else {
 					// accept when stack ends after matching Eof
 					if (st.empty()) {
-						r.success = true;
-						r.trace = out.str();
-						return r;
+						return finish(true);
 					}
 					pos++;
 				}
@@ -443,21 +500,27 @@ LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& t
 				<< " but got " << tokenShort(tokens[pos])
 				<< " at line " << tokens[pos].line << ", column " << tokens[pos].column;
 			out << "ERROR\n";
-			r.success = false;
-			r.trace = out.str();
-			r.error = err.str();
-			return r;
+			reportError(err.str());
+
+			if (X.term == TokenType::Eof) {
+				// leftover input after a complete program: resume the
+				// declaration list if it can start here, otherwise drop it
+				if (lookupProduction(NT::DeclList, lookahead) >= 0) {
+					out << "\t\t\trecover: push " << ntToString(NT::DeclList) << "\n";
+					st.push_back(N(NT::DeclList));
+				} else {
+					skipToken();
+				}
+				continue;
+			}
+			// pretend the missing terminal was there
+			out << "\t\t\trecover: pop " << tokenTypeShort(X.term) << "\n";
+			st.pop_back();
+			continue;
 		}
 
 		// nonterminal
-		auto rowIt = table.find(nti(X.nonterm));
-		int prodIndex = -1;
-		if (rowIt != table.end()) {
-			auto cellIt = rowIt->second.find(lookahead);
-			if (cellIt != rowIt->second.end()) {
-				prodIndex = cellIt->second;
-			}
-		}
+		int prodIndex = lookupProduction(X.nonterm, lookahead);
 
 		if (prodIndex < 0) {
 			std::ostringstream err;
@@ -466,6 +529,7 @@ LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& t
 				<< " at line " << tokens[pos].line << ", column " << tokens[pos].column;
 
 			// show expected terminals (row keys)
+			auto rowIt = table.find(nti(X.nonterm));
 			if (rowIt != table.end()) {
 				err << " (expected one of: ";
 				bool firstOne = true;
@@ -478,10 +542,35 @@ LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& t
 			}
 
 			out << "ERROR\n";
-			r.success = false;
-			r.trace = out.str();
-			r.error = err.str();
-			return r;
+			reportError(err.str());
+
+			// panic mode: skip input until X can continue, X can be finished
+			// (FOLLOW), or a statement boundary is reached
+			while (true) {
+				TokenType a = tokens[pos].type;
+				if (lookupProduction(X.nonterm, a) >= 0) {
+					break;
+				}
+				if (a == TokenType::Eof || inFollow(X.nonterm, a)) {
+					out << "\t\t\trecover: pop " << ntToString(X.nonterm) << "\n";
+					st.pop_back();
+					break;
+				}
+				if (isSyncToken(a)) {
+					// a stray ';' or '}' in a list (e.g. between statements):
+					// drop it when X can start right after it
+					bool terminator = a == TokenType::Semicolon || a == TokenType::RBrace;
+					if (terminator && lookupProduction(X.nonterm, tokens[pos + 1].type) >= 0) {
+						skipToken();
+						break;
+					}
+					out << "\t\t\trecover: pop " << ntToString(X.nonterm) << "\n";
+					st.pop_back();
+					break;
+				}
+				skipToken();
+			}
+			continue;
 		}
 
 		out << productionToString(prodIndex) << "\n";
@@ -494,10 +583,9 @@ LL1TableParser::Result LL1TableParser::parseAndTrace(const std::vector<Token>& t
 		}
 	}
 
-	r.success = false;
-	r.trace = out.str();
-	r.error = "LL1TableParser: exceeded step limit";
-	return r;
+	recovering = false;
+	reportError("LL1TableParser: exceeded step limit");
+	return finish(false);
 }
 
 std::string LL1TableParser::ntToString(NT nt) {
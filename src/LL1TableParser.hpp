@@ -16,13 +16,19 @@ public:
 	struct Result {
 		bool success = false;
 		std::string trace;
-		std::string error;
+		std::string error;               // first error, kept for callers that only show one
+		std::vector<std::string> errors; // every error reported before giving up
 	};
 
+	static constexpr size_t kDefaultMaxErrors = 20;
+
 	LL1TableParser();
 
 	// Runs a table-driven LL(1) parse and returns a human-readable trace.
-	Result parseAndTrace(const std::vector<Token>& tokens) const;
+	// On a syntax error the parser recovers in panic mode (skipping input up to
+	// FOLLOW of the current nonterminal or a ';' / '}' sync token) and keeps
+	// going, so one run reports up to maxErrors errors.
+	Result parseAndTrace(const std::vector<Token>& tokens, size_t maxErrors = kDefaultMaxErrors) const;
 
 private:
 	enum class NT {
@@ -112,6 +118,11 @@ private:
 
 	FirstSet firstOfSequence(const std::vector<Sym>& seq, size_t startIndex = 0) const;
 
+	// panic-mode recovery helpers
+	int lookupProduction(NT nt, TokenType lookahead) const;
+	bool inFollow(NT nt, TokenType t) const;
+	static bool isSyncToken(TokenType t);
+
 	std::string productionToString(int prodIndex) const;
 	static std::string tokenShort(const Token& tok);
 	static std::string tokenTypeShort(TokenType t);
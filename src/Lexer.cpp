@@ -5,6 +5,10 @@ std::vector<Token> Lexer::getTokens()const{
 	return tokens;
 }
 
+const LineMap& Lexer::getLineMap()const{
+	return lineMap;
+}
+
 Lexer::Lexer(){
 	tokens.clear();
 	nowLine=nowColumn=1;
@@ -63,6 +67,7 @@ Lexer::Lexer(){
 void Lexer::setText(std::string text){
 	this->text=text;
 	tokens.clear();
+	lineMap.clear();
 	nowLine=nowColumn=1;
 	nowPos=0;
 }
@@ -78,6 +83,7 @@ char Lexer::get(){
 	if(ch=='\n'){
 		nowLine++;
 		nowColumn=1;
+		lineMap.addLineStart(nowPos+1);
 	}else nowColumn++;
 	nowPos++;
 	return ch;
@@ -287,6 +293,7 @@ Token Lexer::getNextToken(){
 	// 	skip(token);
 	// 	return token;
 	// }
+	size_t start=nowPos;
 	char nowCh=peak();
 	if(isalpha(nowCh)||nowCh=='_')token=scanIdentifier();
 	else if(isdigit(nowCh))token=scanNumber();
@@ -294,6 +301,7 @@ Token Lexer::getNextToken(){
 	else if(nowCh=='"')token=scanString();
 	else token=scanOperatorOrPunct();
 	skip(token);
+	token.offset=start;
 	return token;
 }
 
@@ -308,4 +316,5 @@ void Lexer::doLexer(){
 	}
 	//  EOF token
 	tokens.push_back(Token(TokenType::Eof, nowLine, nowColumn,""));
+	tokens.back().offset=nowPos;
 }
\ No newline at end of file
@@ -5,11 +5,13 @@
 #include <unordered_map>
 #include "TokenType.hpp"
 #include "Token.hpp"
+#include "LineMap.hpp"
 
 class Lexer{
 private:
 	std::string text;
 	std::vector<Token>tokens;
+	LineMap lineMap;
 	int nowLine,nowColumn;
 	size_t nowPos;
 	std::unordered_map<std::string,TokenType>keywords;
@@ -32,6 +34,7 @@ private:
 public:
 	Lexer();
 	std::vector<Token>getTokens()const;
+	const LineMap& getLineMap()const;
 	void setText(std::string text);
 	void doLexer();
 };
\ No newline at end of file
@@ -0,0 +1,14 @@
+#include "LineMap.hpp"
+
+#include <algorithm>
+
+SourceLoc LineMap::locate(uint32_t offset) const {
+	// last line starting at or before offset
+	size_t i = std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin() - 1;
+	return SourceLoc{static_cast<int>(i + 1), static_cast<int>(offset - starts[i] + 1)};
+}
+
+uint32_t LineMap::offsetOf(int line, int column) const {
+	size_t i = std::min(static_cast<size_t>(std::max(line, 1)), starts.size()) - 1;
+	return starts[i] + static_cast<uint32_t>(std::max(column, 1) - 1);
+}
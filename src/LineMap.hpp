@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 1-based line and column of a source offset
+struct SourceLoc {
+	int line = 0;
+	int column = 0;
+};
+
+// Line-start table of a source text. The Lexer fills it while scanning;
+// offsets stored on tokens and AST nodes are turned into line/column only
+// when a diagnostic needs them.
+class LineMap {
+public:
+	LineMap() : starts{0} {}
+
+	void clear() { starts.assign(1, 0); }
+	// offset of the first character after a '\n'
+	void addLineStart(uint32_t offset) { starts.push_back(offset); }
+
+	SourceLoc locate(uint32_t offset) const;
+	uint32_t offsetOf(int line, int column) const;
+	size_t lineCount() const { return starts.size(); }
+	// offset of line i + 1
+	uint32_t lineStart(size_t i) const { return starts[i]; }
+
+private:
+	std::vector<uint32_t> starts;	// starts[i] = offset of line i + 1
+};
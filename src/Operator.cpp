@@ -0,0 +1,59 @@
+#include "Operator.hpp"
+
+const char *opSpelling(BinaryOp op){
+	switch(op){
+		case BinaryOp::Add: return "+";
+		case BinaryOp::Sub: return "-";
+		case BinaryOp::Mul: return "*";
+		case BinaryOp::Div: return "/";
+		case BinaryOp::Mod: return "%";
+		case BinaryOp::Lt: return "<";
+		case BinaryOp::Gt: return ">";
+		case BinaryOp::Le: return "<=";
+		case BinaryOp::Ge: return ">=";
+		case BinaryOp::Eq: return "==";
+		case BinaryOp::Ne: return "!=";
+		case BinaryOp::And: return "&&";
+		case BinaryOp::Or: return "||";
+	}
+	return "?";
+}
+
+const char *opSpelling(UnaryOp op){
+	switch(op){
+		case UnaryOp::Plus: return "+";
+		case UnaryOp::Minus: return "-";
+		case UnaryOp::Deref: return "*";
+		case UnaryOp::Not: return "!";
+	}
+	return "?";
+}
+
+bool binaryOpFromToken(TokenType t, BinaryOp &op){
+	switch(t){
+		case TokenType::Plus: op=BinaryOp::Add; return true;
+		case TokenType::Minus: op=BinaryOp::Sub; return true;
+		case TokenType::Star: op=BinaryOp::Mul; return true;
+		case TokenType::Slash: op=BinaryOp::Div; return true;
+		case TokenType::Percent: op=BinaryOp::Mod; return true;
+		case TokenType::Less: op=BinaryOp::Lt; return true;
+		case TokenType::Greater: op=BinaryOp::Gt; return true;
+		case TokenType::LessEq: op=BinaryOp::Le; return true;
+		case TokenType::GreaterEq: op=BinaryOp::Ge; return true;
+		case TokenType::Equal: op=BinaryOp::Eq; return true;
+		case TokenType::NotEq: op=BinaryOp::Ne; return true;
+		case TokenType::LogicalAnd: op=BinaryOp::And; return true;
+		case TokenType::LogicalOr: op=BinaryOp::Or; return true;
+		default: return false;
+	}
+}
+
+bool unaryOpFromToken(TokenType t, UnaryOp &op){
+	switch(t){
+		case TokenType::Plus: op=UnaryOp::Plus; return true;
+		case TokenType::Minus: op=UnaryOp::Minus; return true;
+		case TokenType::Star: op=UnaryOp::Deref; return true;
+		case TokenType::Not: op=UnaryOp::Not; return true;
+		default: return false;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "TokenType.hpp"
+
+// Operators of the C subset, as compact enums instead of lexeme strings
+enum class BinaryOp : unsigned char {
+	Add, Sub, Mul, Div, Mod,	// + - * / %
+	Lt, Gt, Le, Ge,				// < > <= >=
+	Eq, Ne,						// == !=
+	And, Or,					// && ||
+};
+
+enum class UnaryOp : unsigned char {
+	Plus, Minus, Deref, Not,	// + - * !
+};
+
+// Source spelling, e.g. BinaryOp::Le -> "<="
+const char *opSpelling(BinaryOp op);
+const char *opSpelling(UnaryOp op);
+
+// Token -> operator; false if the token is not an operator of that arity
+bool binaryOpFromToken(TokenType t, BinaryOp &op);
+bool unaryOpFromToken(TokenType t, UnaryOp &op);
@@ -0,0 +1,17 @@
+#include "Optimizer.hpp"
+
+#include "ConstProp.hpp"
+#include "DeadCode.hpp"
+#include "ValueNumbering.hpp"
+
+size_t optimizeTac(TacModule& module) {
+	size_t removed = 0;
+	for (TacFunction& fn : module.functions) {
+		size_t before = fn.code.size();
+		propagateConstants(fn);
+		numberValues(fn);
+		eliminateDeadCode(fn);
+		removed += before - fn.code.size();
+	}
+	return removed;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Tac.hpp"
+
+#include <cstddef>
+
+// Runs constant propagation, value numbering and dead code elimination, in
+// that order, over every function of the module, global initializer units
+// included. Each pass leaves work for the next: folded branches leave
+// unreachable blocks, and reused values leave their old temps unread.
+//
+// Returns the number of instructions removed.
+size_t optimizeTac(TacModule& module);
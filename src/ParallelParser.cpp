@@ -0,0 +1,145 @@
+#include "ParallelParser.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace {
+
+// Below this many tokens the threads cost more than they save.
+constexpr size_t kMinParallelTokens = 16 * 1024;
+
+// Chunks per thread: a few more than one keeps threads busy when
+// declarations differ a lot in size.
+constexpr size_t kChunksPerThread = 4;
+
+struct Chunk {
+	size_t firstDecl = 0;
+	size_t lastDecl = 0;	// exclusive
+	ProgramPtr prog;
+	std::vector<ParseDiagnostic> diags;
+};
+
+// Groups consecutive declarations into chunks of roughly equal token count.
+std::vector<Chunk> makeChunks(const std::vector<DeclSpan>& spans, size_t target) {
+	std::vector<Chunk> chunks;
+	if (spans.empty()) return chunks;
+	size_t total = spans.back().end - spans.front().begin;
+	size_t perChunk = std::max<size_t>(1, total / std::max<size_t>(1, target));
+	Chunk cur;
+	size_t tokens = 0;
+	for (size_t i = 0; i < spans.size(); ++i) {
+		tokens += spans[i].end - spans[i].begin;
+		if (tokens >= perChunk || i + 1 == spans.size()) {
+			cur.lastDecl = i + 1;
+			chunks.push_back(std::move(cur));
+			cur = Chunk();
+			cur.firstDecl = i + 1;
+			tokens = 0;
+		}
+	}
+	return chunks;
+}
+
+} // namespace
+
+ParallelParser::ParallelParser(unsigned threads) : threadCount(threads) {
+	if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<DeclSpan> ParallelParser::findTopLevelDecls(const std::vector<Token>& tokens) {
+	std::vector<DeclSpan> spans;
+	size_t n = tokens.size();
+	if (n > 0 && tokens[n - 1].type == TokenType::Eof) --n;
+
+	size_t begin = 0;
+	int braces = 0;
+	int parens = 0;
+	for (size_t i = 0; i < n; ++i) {
+		switch (tokens[i].type) {
+			case TokenType::LParen: ++parens; break;
+			case TokenType::RParen: --parens; break;
+			case TokenType::LBrace: ++braces; break;
+			case TokenType::RBrace:
+				// the closing brace of a function body ends the declaration
+				if (--braces == 0 && parens == 0) {
+					spans.push_back(DeclSpan{begin, i + 1});
+					begin = i + 1;
+				}
+				break;
+			case TokenType::Semicolon:
+				// global variable: `type IDENT [= expr] ;`
+				if (braces == 0 && parens == 0) {
+					spans.push_back(DeclSpan{begin, i + 1});
+					begin = i + 1;
+				}
+				break;
+			default: break;
+		}
+	}
+	if (begin < n) spans.push_back(DeclSpan{begin, n});
+	return spans;
+}
+
+ProgramPtr ParallelParser::parse(const std::vector<Token>& tokens) {
+	diags.clear();
+
+	std::vector<DeclSpan> spans = findTopLevelDecls(tokens);
+	size_t workers = std::min<size_t>(threadCount, spans.size());
+	if (workers <= 1 || tokens.size() < kMinParallelTokens) {
+		Parser parser;
+		parser.setTokens(tokens);
+		ProgramPtr prog = parser.parse();
+		diags = parser.diagnostics();
+		return prog;
+	}
+
+	std::vector<Chunk> chunks = makeChunks(spans, workers * kChunksPerThread);
+	workers = std::min(workers, chunks.size());
+
+	std::atomic<size_t> next{0};
+	std::exception_ptr failure;
+	std::atomic<bool> failed{false};
+	auto work = [&]() {
+		try {
+			for (size_t c = next++; c < chunks.size(); c = next++) {
+				Chunk& chunk = chunks[c];
+				size_t b = spans[chunk.firstDecl].begin;
+				size_t e = spans[chunk.lastDecl - 1].end;
+				Parser parser;
+				// setTokens appends the Eof sentinel
+				parser.setTokens(std::vector<Token>(tokens.begin() + b, tokens.begin() + e));
+				chunk.prog = parser.parse();
+				chunk.diags = parser.diagnostics();
+			}
+		} catch (...) {
+			// only the first failure is kept; the others see an empty queue
+			if (!failed.exchange(true)) failure = std::current_exception();
+			next = chunks.size();
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(workers - 1);
+	for (size_t t = 1; t < workers; ++t) pool.emplace_back(work);
+	work();
+	for (auto& th : pool) th.join();
+	if (failure) std::rethrow_exception(failure);
+
+	// splice chunk results in source order
+	auto prog = std::make_unique<Program>();
+	prog->decls.reserve(spans.size());
+	for (Chunk& chunk : chunks) {
+		for (auto& d : chunk.prog->decls) {
+			if (d) prog->decls.push_back(std::move(d));
+		}
+		prog->adoptedArenas.push_back(std::move(chunk.prog->arena));
+		for (auto& a : chunk.prog->adoptedArenas) prog->adoptedArenas.push_back(std::move(a));
+		diags.insert(diags.end(), chunk.diags.begin(), chunk.diags.end());
+	}
+	// the range a single Parser gives the program: up to the last token
+	const Token& last = tokens[spans.back().end - 1];
+	prog->end = last.offset + static_cast<uint32_t>(last.lexeme.size());
+	return prog;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "AST.hpp"
+#include "Parser.hpp"
+#include "Token.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Token range [begin, end) of one top-level declaration
+struct DeclSpan {
+	size_t begin = 0;
+	size_t end = 0;
+};
+
+// Parses top-level declarations on several threads.
+//
+// A brace-matching scan over the token stream splits it into declarations
+// (`type IDENT ... ;` or `type IDENT ( ... ) { ... }`). Runs of consecutive
+// declarations are grouped into chunks, each chunk is parsed by its own
+// Parser into its own arena, and the results are spliced into one Program
+// in source order. The Program adopts the chunk arenas, so the tree is the
+// same as the one Parser::parse builds from the whole stream.
+class ParallelParser {
+public:
+	// threads == 0 uses std::thread::hardware_concurrency()
+	explicit ParallelParser(unsigned threads = 0);
+
+	// Always returns a Program; see diagnostics() for syntax errors, which
+	// are reported per chunk in source order.
+	ProgramPtr parse(const std::vector<Token>& tokens);
+
+	const std::vector<ParseDiagnostic>& diagnostics() const { return diags; }
+	bool hasErrors() const { return !diags.empty(); }
+
+	// Top-level declaration boundaries; the trailing Eof is not part of any
+	// span. An unbalanced tail becomes the last span and fails in the parser.
+	static std::vector<DeclSpan> findTopLevelDecls(const std::vector<Token>& tokens);
+
+private:
+	unsigned threadCount;
+	std::vector<ParseDiagnostic> diags;
+};
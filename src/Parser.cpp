@@ -1,64 +1,177 @@
 #include "Parser.hpp"
+#include <array>
 #include <iostream>
 
+namespace {
+
+// Binary operator table for precedence climbing, indexed by TokenType.
+// prec 0 marks tokens that are not binary operators; higher binds tighter.
+constexpr int kLowestBinaryPrec = 1;
+
+constexpr size_t kTokenTypeCount = static_cast<size_t>(TokenType::Eof) + 1;
+
+constexpr std::array<BinaryOpInfo, kTokenTypeCount> makeBinaryOpTable() {
+	std::array<BinaryOpInfo, kTokenTypeCount> t{};
+	auto set = [&t](TokenType tt, int prec, BinaryOp op) {
+		t[static_cast<size_t>(tt)] = BinaryOpInfo{prec, op};
+	};
+	set(TokenType::LogicalOr, 1, BinaryOp::Or);
+	set(TokenType::LogicalAnd, 2, BinaryOp::And);
+	set(TokenType::Equal, 3, BinaryOp::Eq);
+	set(TokenType::NotEq, 3, BinaryOp::Ne);
+	set(TokenType::Less, 4, BinaryOp::Lt);
+	set(TokenType::Greater, 4, BinaryOp::Gt);
+	set(TokenType::LessEq, 4, BinaryOp::Le);
+	set(TokenType::GreaterEq, 4, BinaryOp::Ge);
+	set(TokenType::Plus, 5, BinaryOp::Add);
+	set(TokenType::Minus, 5, BinaryOp::Sub);
+	set(TokenType::Star, 6, BinaryOp::Mul);
+	set(TokenType::Slash, 6, BinaryOp::Div);
+	set(TokenType::Percent, 6, BinaryOp::Mod);
+	return t;
+}
+
+constexpr auto kBinaryOps = makeBinaryOpTable();
+
+const BinaryOpInfo& binaryOpInfo(TokenType t) {
+	return kBinaryOps[static_cast<size_t>(t)];
+}
+
+// Type keywords start a declaration, so they are safe places to resume.
+bool isTypeKeyword(TokenType t) {
+	return t == TokenType::kw_int || t == TokenType::kw_char || t == TokenType::kw_void || t == TokenType::kw_double;
+}
+
+} // namespace
 
 
-Parser::Parser() : pos(0) {}
+std::string ParseDiagnostic::toString() const {
+	return "Parser: " + message + " at line " + std::to_string(line) + ", column " + std::to_string(column);
+}
+
+Parser::Parser() : pos(0) {
+	setTokens({});
+}
 
 void Parser::setTokens(const std::vector<Token>& toks) {
-	tokens = toks;
-	pos = 0;
+	setTokens(std::vector<Token>(toks));
 }
 
-Token& Parser::curToken() {
-	if (pos >= tokens.size()) {
-		throw std::out_of_range("Parser: curToken() position out of range");
+void Parser::setTokens(std::vector<Token>&& toks) {
+	tokens = std::move(toks);
+	// ֤ĩβEofڱ֮ķʶټ߽
+	if (tokens.empty() || tokens.back().type != TokenType::Eof) {
+		Token eof;
+		eof.type = TokenType::Eof;
+		if (!tokens.empty()) {
+			eof.line = tokens.back().line;
+			eof.column = tokens.back().column;
+		}
+		tokens.push_back(eof);
 	}
+	pos = 0;
+	lastEnd = 0;
+	diags.clear();
+	panicking = false;
+}
+
+const Token& Parser::curToken() const {
 	return tokens[pos];
 }
 
-Token& Parser::peek(int offset) {
-	if (pos + offset >= tokens.size()) {
-		throw std::out_of_range("Parser: peek() position out of range :"+std::to_string(pos + offset));
-	}
-	return tokens[pos + offset];
+const Token& Parser::peek(int offset) const {
+	size_t i = pos + offset;
+	return tokens[i < tokens.size() ? i : tokens.size() - 1];
 }
 
 void Parser::advance() {
-	if (pos < tokens.size()) {
+	if (tokens[pos].type != TokenType::Eof) {
+		lastEnd = tokens[pos].offset + static_cast<uint32_t>(tokens[pos].lexeme.size());
 		pos++;
 	}
 }
 
-bool Parser::check(TokenType t) {
-	return curToken().type == t;
+bool Parser::check(TokenType t) const {
+	return tokens[pos].type == t;
 }
 
 void Parser::expect(TokenType t) {
 	if (!check(t)) {
-		std::string msg = "Parser: expected token type ";
-		msg += tokenTypeToString(t);
-		msg += " but got ";
-		msg += tokenTypeToString(curToken().type);
-		msg += " at line " + std::to_string(curToken().line) + ", column " + std::to_string(curToken().column);
-		throw std::runtime_error(msg);
+		error("expected token type " + tokenTypeToString(t) + " but got " + tokenTypeToString(curToken().type));
+		return;
 	}
 	advance();
 }
 
+void Parser::error(const std::string &msg) {
+	// ֻģʽµĴǵһ
+	if (!panicking) {
+		diags.push_back(ParseDiagnostic{curToken().line, curToken().column, msg});
+	}
+	panicking = true;
+}
+
+void Parser::syncStmt(size_t start) {
+	panicking = false;
+	// ԼѾԵ ;  }
+	if (pos > start) {
+		TokenType last = tokens[pos - 1].type;
+		if (last == TokenType::Semicolon || last == TokenType::RBrace) return;
+	} else {
+		// һTokenûѣһ֤ǰ
+		advance();
+	}
+	int depth = 0;
+	while (!check(TokenType::Eof)) {
+		TokenType t = curToken().type;
+		if (depth == 0) {
+			if (t == TokenType::Semicolon) { advance(); return; }
+			if (t == TokenType::RBrace || isTypeKeyword(t)) return;
+		}
+		if (t == TokenType::LBrace) depth++;
+		else if (t == TokenType::RBrace) depth--;
+		advance();
+	}
+}
+
+void Parser::syncDecl(size_t start) {
+	panicking = false;
+	if (pos == start) advance();
+	int depth = 0;
+	while (!check(TokenType::Eof)) {
+		TokenType t = curToken().type;
+		if (depth == 0 && isTypeKeyword(t)) return;
+		if (t == TokenType::LBrace) {
+			depth++;
+		} else if (t == TokenType::RBrace) {
+			//  } ֱ
+			if (depth > 0 && --depth == 0) { advance(); return; }
+		} else if (t == TokenType::Semicolon && depth == 0) {
+			advance();
+			return;
+		}
+		advance();
+	}
+}
+
 // 캯
-Parser::Parser(const std::vector<Token>& toks) : tokens(toks), pos(0) {}
+Parser::Parser(const std::vector<Token>& toks) : pos(0) {
+	setTokens(toks);
+}
 
 // 
 ProgramPtr Parser::parse() {
 	auto prog = std::make_unique<Program>();
-	prog->decls = std::vector<DeclPtr>();
-	
+	arena = prog->arena.get();
+
 	// program ::= decl program | EOF
 	while (!check(TokenType::Eof)) {
-		prog->decls.push_back(parseDecl());
+		size_t start = pos;
+		auto decl = parseDecl();
+		if (decl) prog->decls.push_back(std::move(decl));
+		if (panicking) syncDecl(start);
 	}
-	expect(TokenType::Eof);
+	finish(*prog, 0);
 	return prog;
 }
 
@@ -70,6 +183,7 @@ DeclPtr Parser::parseDecl() {
 	//          func_decl = type IDENT ( ... ) { ... }
 	
 	// Ƚͺͱʶ
+	uint32_t begin = curToken().offset;
 	Type type;
 	if (check(TokenType::kw_int)) {
 		type = Type::INT;
@@ -84,11 +198,13 @@ DeclPtr Parser::parseDecl() {
 		type = Type::DOUBLE;
 		advance();
 	}else {
-		throw std::runtime_error("Parser: expected type specifier at line"+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
+		error("expected type specifier");
+		return nullptr;
 	}
 
 	if (!check(TokenType::Identifier)) {
-		throw std::runtime_error("Parser: expected identifier at line "+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
+		error("expected identifier");
+		return nullptr;
 	}
 	std::string name = curToken().lexeme;
 	advance();
@@ -96,26 +212,29 @@ DeclPtr Parser::parseDecl() {
 	// ǰжǱǺ
 	if (check(TokenType::Semicolon)) {
 		// ޳ʼint x;
-		auto varDecl = std::make_unique<VarDecl>();
+		auto varDecl = make<VarDecl>();
 		varDecl->type = type;
-		varDecl->name = name;
+		setName(*varDecl, name);
 		varDecl->init = nullptr;
 		advance(); //  ;
+		finish(*varDecl, begin);
 		return varDecl;
 	} else if (check(TokenType::Assign)) {
 		// гʼint x = expr;
-		auto varDecl = std::make_unique<VarDecl>();
+		auto varDecl = make<VarDecl>();
 		varDecl->type = type;
-		varDecl->name = name;
+		setName(*varDecl, name);
 		advance(); //  =
 		varDecl->init = parseExpr();
 		expect(TokenType::Semicolon);
+		finish(*varDecl, begin);
 		return varDecl;
 	} else if (check(TokenType::LParen)) {
 		// type name ( ... ) { ... }
-		return parseFunDecl(type, name);  // ѽ type  name
+		return parseFunDecl(type, name, begin);  // ѽ type  name
 	} else {
-		throw std::runtime_error("Parser: unexpected token after identifier at line "+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
+		error("unexpected token after identifier");
+		return nullptr;
 	}
 }
 
@@ -123,19 +242,19 @@ DeclPtr Parser::parseDecl() {
 DeclPtr Parser::parseVarDecl() {
 	// val_decl ::= type_spec IDENT init_opt ";"
 	// ˴ͺͱʶѱ
-	auto varDecl = std::make_unique<VarDecl>();
+	auto varDecl = make<VarDecl>();
 	//  parseDecl д
 	return varDecl;
 }
 
 
 // 壨ѽķͺͺ
-DeclPtr Parser::parseFunDecl(Type returnType, const std::string &name) {
+DeclPtr Parser::parseFunDecl(Type returnType, const std::string &name, uint32_t begin) {
 	// ǰ token Ӧ LParen
 	expect(TokenType::LParen);
-	auto funDecl = std::make_unique<FunDecl>();
+	auto funDecl = make<FunDecl>();
 	funDecl->returnType = returnType;
-	funDecl->name = name;
+	setName(*funDecl, name);
 	// б
 	funDecl->params.clear();
 	
@@ -145,17 +264,19 @@ DeclPtr Parser::parseFunDecl(Type returnType, const std::string &name) {
 	} else if (!check(TokenType::RParen)) {
 		// б
 		while (true) {
+			uint32_t paramBegin = curToken().offset;
 			Type ptype;
 			if (check(TokenType::kw_int)) { ptype = Type::INT; advance(); }
 			else if (check(TokenType::kw_char)) { ptype = Type::CHAR; advance(); }
 			else if (check(TokenType::kw_double)) { ptype = Type::DOUBLE; advance(); }
-			else throw std::runtime_error("Parser: expected parameter type at line "+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
+			else { error("expected parameter type"); break; }
 
-			if (!check(TokenType::Identifier)) throw std::runtime_error("Parser: expected parameter name at line "+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
-			auto param = std::make_unique<Param>();
+			if (!check(TokenType::Identifier)) { error("expected parameter name"); break; }
+			auto param = make<Param>();
 			param->type = ptype;
-			param->name = curToken().lexeme;
+			setName(*param, curToken().lexeme);
 			advance();
+			finish(*param, paramBegin);
 			funDecl->params.push_back(std::move(param));
 
 			if (check(TokenType::Comma)) { advance(); continue; }
@@ -163,21 +284,26 @@ DeclPtr Parser::parseFunDecl(Type returnType, const std::string &name) {
 		}
 	}
 	expect(TokenType::RParen);
-	// 壺
-	funDecl->body = parseCompoundStmt();
+	// ͷͬ
+	if (!panicking) {
+		// 壺
+		funDecl->body = parseCompoundStmt();
+	}
+	finish(*funDecl, begin);
 	return funDecl;
 }
 
 // 
 StmtPtr Parser::parseStmt() {
 	// stmt ::= expr_stmt | compound_stmt | if_stmt | while_stmt | for_stmt | return_stmt | val_decl
+	uint32_t begin = curToken().offset;
 	if (check(TokenType::LBrace)) {
 		// ظ䱾Ϊһ Stmt
 		return parseCompoundStmt();
 	} else if (check(TokenType::kw_if)) {
 		advance();
 		expect(TokenType::LParen);
-		auto ifStmt = std::make_unique<IfStmt>();
+		auto ifStmt = make<IfStmt>();
 		ifStmt->cond = parseExpr();
 		expect(TokenType::RParen);
 		ifStmt->thenBranch = parseStmt();
@@ -187,19 +313,21 @@ StmtPtr Parser::parseStmt() {
 		} else {
 			ifStmt->elseBranch = nullptr;
 		}
+		finish(*ifStmt, begin);
 		return ifStmt;
 	} else if (check(TokenType::kw_while)) {
 		advance();
 		expect(TokenType::LParen);
-		auto whileStmt = std::make_unique<WhileStmt>();
+		auto whileStmt = make<WhileStmt>();
 		whileStmt->cond = parseExpr();
 		expect(TokenType::RParen);
 		whileStmt->body = parseStmt();
+		finish(*whileStmt, begin);
 		return whileStmt;
 	} else if (check(TokenType::kw_for)) {
 		advance();
 		expect(TokenType::LParen);
-		auto forStmt = std::make_unique<ForStmt>();
+		auto forStmt = make<ForStmt>();
 		// for ( expr_opt ; expr_opt ; expr_opt ) stmt
 		forStmt->init = check(TokenType::Semicolon) ? nullptr : parseExpr();
 		expect(TokenType::Semicolon);
@@ -208,30 +336,38 @@ StmtPtr Parser::parseStmt() {
 		forStmt->update = check(TokenType::RParen) ? nullptr : parseExpr();
 		expect(TokenType::RParen);
 		forStmt->body = parseStmt();
+		finish(*forStmt, begin);
 		return forStmt;
 	} else if (check(TokenType::kw_return)) {
 		advance();
-		auto returnStmt = std::make_unique<ReturnStmt>();
+		auto returnStmt = make<ReturnStmt>();
 		returnStmt->expr = check(TokenType::Semicolon) ? nullptr : parseExpr();
 		expect(TokenType::Semicolon);
+		finish(*returnStmt, begin);
 		return returnStmt;
 	} else {
 		// ʽ
-		auto exprStmt = std::make_unique<ExprStmt>();
+		auto exprStmt = make<ExprStmt>();
 		exprStmt->expr = parseExpr();
 		expect(TokenType::Semicolon);
+		finish(*exprStmt, begin);
 		return exprStmt;
 	}
 }
 
 // 
-std::unique_ptr<CompoundStmt> Parser::parseCompoundStmt() {
-	expect(TokenType::LBrace);
-	auto compound = std::make_unique<CompoundStmt>();
-	compound->localVars = std::vector<std::unique_ptr<VarDecl>>();
-	compound->stmts = std::vector<StmtPtr>();
+NodePtr<CompoundStmt> Parser::parseCompoundStmt() {
+	auto compound = make<CompoundStmt>();
+	uint32_t begin = curToken().offset;
+	if (!check(TokenType::LBrace)) {
+		// û { ʱ̵ܰ
+		expect(TokenType::LBrace);
+		return compound;
+	}
+	advance();
 
-	while (!check(TokenType::RBrace)) {
+	while (!check(TokenType::RBrace) && !check(TokenType::Eof)) {
+		size_t start = pos;
 		// Խֲ
 		if (check(TokenType::kw_int) || check(TokenType::kw_char) || check(TokenType::kw_void)||check(TokenType::kw_double)) {
 			// ֲֵֻ֧ʽ type ident [= expr] ; 
@@ -241,21 +377,25 @@ std::unique_ptr<CompoundStmt> Parser::parseCompoundStmt() {
 			else if (check(TokenType::kw_double)) { vtype = Type::DOUBLE; advance(); }
 			else { vtype = Type::VOID; advance(); }
 
-			if (!check(TokenType::Identifier)) throw std::runtime_error("Parser: expected identifier in local declaration at line "+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
+			if (!check(TokenType::Identifier)) { error("expected identifier in local declaration"); syncStmt(start); continue; }
 			std::string vname = curToken().lexeme; advance();
-			auto vdecl = std::make_unique<VarDecl>();
-			vdecl->type = vtype; vdecl->name = vname; vdecl->init = nullptr;
+			auto vdecl = make<VarDecl>();
+			vdecl->type = vtype; setName(*vdecl, vname); vdecl->init = nullptr;
 			if (check(TokenType::Assign)) {
 				advance();
 				vdecl->init = parseExpr();
 			}
 			expect(TokenType::Semicolon);
+			finish(*vdecl, tokens[start].offset);
 			compound->localVars.push_back(std::move(vdecl));
+			if (panicking) syncStmt(start);
 			continue;
 		}
 		compound->stmts.push_back(parseStmt());
+		if (panicking) syncStmt(start);
 	}
 	expect(TokenType::RBrace);
+	finish(*compound, begin);
 	return compound;
 }
 
@@ -265,91 +405,35 @@ ExprPtr Parser::parseExpr() {
 }
 
 ExprPtr Parser::parseAssignmentExpr() {
-	auto left = parseLogicalOrExpr();
+	uint32_t begin = curToken().offset;
+	auto left = parseBinaryExpr(kLowestBinaryPrec);
 	if (check(TokenType::Assign)) {
 		advance();
 		auto right = parseAssignmentExpr();
-		auto assignExpr = std::make_unique<AssignExpr>();
+		auto assignExpr = make<AssignExpr>();
 		assignExpr->left = std::move(left);
 		assignExpr->right = std::move(right);
+		finish(*assignExpr, begin);
 		return assignExpr;
 	}
 	return left;
 }
 
-ExprPtr Parser::parseLogicalOrExpr() {
-	auto left = parseLogicalAndExpr();
-	while (check(TokenType::LogicalOr)) {
-		auto binExpr = std::make_unique<BinaryExpr>();
-		binExpr->op = curToken().lexeme;
-		advance();
-		binExpr->left = std::move(left);
-		binExpr->right = parseLogicalAndExpr();
-		left = std::move(binExpr);
-	}
-	return left;
-}
-
-ExprPtr Parser::parseLogicalAndExpr() {
-	auto left = parseEqualityExpr();
-	while (check(TokenType::LogicalAnd)) {
-		auto binExpr = std::make_unique<BinaryExpr>();
-		binExpr->op = curToken().lexeme;
-		advance();
-		binExpr->left = std::move(left);
-		binExpr->right = parseEqualityExpr();
-		left = std::move(binExpr);
-	}
-	return left;
-}
-
-ExprPtr Parser::parseEqualityExpr() {
-	auto left = parseRelationalExpr();
-	while (check(TokenType::Equal) || check(TokenType::NotEq)) {
-		auto binExpr = std::make_unique<BinaryExpr>();
-		binExpr->op = curToken().lexeme;
-		advance();
-		binExpr->left = std::move(left);
-		binExpr->right = parseRelationalExpr();
-		left = std::move(binExpr);
-	}
-	return left;
-}
-
-ExprPtr Parser::parseRelationalExpr() {
-	auto left = parseAdditiveExpr();
-	while (check(TokenType::Less) || check(TokenType::Greater) || check(TokenType::LessEq) || check(TokenType::GreaterEq)) {
-		auto binExpr = std::make_unique<BinaryExpr>();
-		binExpr->op = curToken().lexeme;
-		advance();
-		binExpr->left = std::move(left);
-		binExpr->right = parseAdditiveExpr();
-		left = std::move(binExpr);
-	}
-	return left;
-}
-
-ExprPtr Parser::parseAdditiveExpr() {
-	auto left = parseMultiplicativeExpr();
-	while (check(TokenType::Plus) || check(TokenType::Minus)) {
-		auto binExpr = std::make_unique<BinaryExpr>();
-		binExpr->op = curToken().lexeme;
-		advance();
-		binExpr->left = std::move(left);
-		binExpr->right = parseMultiplicativeExpr();
-		left = std::move(binExpr);
-	}
-	return left;
-}
-
-ExprPtr Parser::parseMultiplicativeExpr() {
+ExprPtr Parser::parseBinaryExpr(int minPrec) {
+	// ϣÿ㶼ʼ
+	uint32_t begin = curToken().offset;
 	auto left = parseUnaryExpr();
-	while (check(TokenType::Star) || check(TokenType::Slash) || check(TokenType::Percent)) {
-		auto binExpr = std::make_unique<BinaryExpr>();
-		binExpr->op = curToken().lexeme;
+	for (;;) {
+		const BinaryOpInfo& info = binaryOpInfo(curToken().type);
+		if (info.prec < minPrec) break;	// also stops on non-operators (prec 0)
+		auto binExpr = make<BinaryExpr>();
+		binExpr->op = info.op;
 		advance();
 		binExpr->left = std::move(left);
-		binExpr->right = parseUnaryExpr();
+		// all binary operators are left-associative: the right operand only
+		// takes operators that bind tighter
+		binExpr->right = parseBinaryExpr(info.prec + 1);
+		finish(*binExpr, begin);
 		left = std::move(binExpr);
 	}
 	return left;
@@ -357,30 +441,36 @@ ExprPtr Parser::parseMultiplicativeExpr() {
 
 ExprPtr Parser::parseUnaryExpr() {
 	if (check(TokenType::Plus) || check(TokenType::Minus) || check(TokenType::Star) || check(TokenType::Not)) {
-		auto unaryExpr = std::make_unique<UnaryExpr>();
-		unaryExpr->op = curToken().lexeme;
+		auto unaryExpr = make<UnaryExpr>();
+		uint32_t begin = curToken().offset;
+		unaryOpFromToken(curToken().type, unaryExpr->op);
 		advance();
 		unaryExpr->operand = parseUnaryExpr();
+		finish(*unaryExpr, begin);
 		return unaryExpr;
 	}
 	return parsePrimaryExpr();
 }
 
 ExprPtr Parser::parsePrimaryExpr() {
+	uint32_t begin = curToken().offset;
 	if (check(TokenType::IntLiterial)) {
-		auto intLit = std::make_unique<IntLiteral>();
+		auto intLit = make<IntLiteral>();
 		intLit->lexeme = curToken().lexeme;
 		advance();
+		finish(*intLit, begin);
 		return intLit;
 	} else if (check(TokenType::CharLiterial)) {
-		auto charLit = std::make_unique<CharLiteral>();
+		auto charLit = make<CharLiteral>();
 		charLit->lexeme = curToken().lexeme;
 		advance();
+		finish(*charLit, begin);
 		return charLit;
 	} else if (check(TokenType::DoubleLiterial)) {
-		auto doubleLit = std::make_unique<DoubleLiteral>();
+		auto doubleLit = make<DoubleLiteral>();
 		doubleLit->lexeme = curToken().lexeme;
 		advance();
+		finish(*doubleLit, begin);
 		return doubleLit;
 	}else if (check(TokenType::Identifier)) {
 		std::string name = curToken().lexeme;
@@ -388,29 +478,34 @@ ExprPtr Parser::parsePrimaryExpr() {
 		if (check(TokenType::LParen)) {
 			// 
 			advance();
-			auto callExpr = std::make_unique<CallExpr>();
-			callExpr->name = name;
-			callExpr->args = std::vector<ExprPtr>();
-			while (!check(TokenType::RParen)) {
+			auto callExpr = make<CallExpr>();
+			setName(*callExpr, name);
+			while (!check(TokenType::RParen) && !check(TokenType::Eof)) {
 				callExpr->args.push_back(parseExpr());
+				if (panicking) break;
 				if (!check(TokenType::RParen)) {
 					expect(TokenType::Comma);
 				}
 			}
 			expect(TokenType::RParen);
+			finish(*callExpr, begin);
 			return callExpr;
 		} else {
 			// 
-			auto valExpr = std::make_unique<ValExpr>();
-			valExpr->name = name;
+			auto valExpr = make<ValExpr>();
+			setName(*valExpr, name);
+			finish(*valExpr, begin);
 			return valExpr;
 		}
 	} else if (check(TokenType::LParen)) {
 		advance();
 		auto expr = parseExpr();
 		expect(TokenType::RParen);
+		// ţָԴдıʽ
+		if (expr) finish(*expr, begin);
 		return expr;
 	} else {
-		throw std::runtime_error("Parser: unexpected token in primary expression at line "+std::to_string(curToken().line)+", column "+std::to_string(curToken().column));
+		error("unexpected token in primary expression");
+		return nullptr;
 	}
 }
@@ -2,24 +2,61 @@
 #include "Lexer.hpp"
 #include "Token.hpp"
 #include "AST.hpp"
+#include <string>
 #include <vector>
-#include <stdexcept>
+
+// ԪȼӦBinaryOp
+struct BinaryOpInfo{
+	int prec=0;
+	BinaryOp op=BinaryOp::Add;
+};
+
+// ﷨λֿ棬ɵ÷
+struct ParseDiagnostic{
+	int line=0;
+	int column=0;
+	std::string message;
+	// "Parser: <message> at line L, column C"
+	std::string toString() const;
+};
 
 class Parser{
 	private:
+	// ĩβһEofڱposԶԽ
 	std::vector<Token>tokens;
 	size_t pos=0;
+	// һѵTokenĽƫ
+	uint32_t lastEnd=0;
+	std::vector<ParseDiagnostic> diags;
+	// ֻģʽټ¼ֱָͬ
+	bool panicking=false;
+	// arena of the Program being built
+	AstArena *arena=nullptr;
+
+	template<class T>
+	NodePtr<T> make(){ return makeNode<T>(*arena); }
 
 	// ǰToken
-	Token& curToken();
-	// 鿴λoffsetToken
-	Token& peek(int offset=1);
-	// 
+	const Token& curToken() const;
+	// 鿴λoffsetTokenԽʱEof
+	const Token& peek(int offset=1) const;
+	// ͣEof
 	void advance();
+	// ýԴ䣺beginһѵTokenĩβ
+	void finish(ASTNode &node, uint32_t begin) const { node.begin = begin; node.end = lastEnd; }
+	// ýıʶڱʶеı
+	template<class T>
+	void setName(T &node, const std::string &name) const { node.name = name; node.nameId = identifiers().intern(name); }
 	// 鵱ǰTokenTokenTypeǷΪt
-	bool check(TokenType t);
-	// ѵǰToken
+	bool check(TokenType t) const;
+	// ѵǰTokenƥʱ
 	void expect(TokenType t);
+	// ڵǰToken󲢽ֻģʽ
+	void error(const std::string &msg);
+	// 伶ͬ ; ֮󣬻ͣ } ͹ؼǰstartΪ
+	void syncStmt(size_t start);
+	// ͬĶ壩ͣһ͹ؼǰ
+	void syncDecl(size_t start);
 
 	// ݹ½
 	// 
@@ -30,27 +67,17 @@ class Parser{
 	// 
 	DeclPtr parseVarDecl();
 	// 
-	DeclPtr parseFunDecl(Type returnType, const std::string &name);
+	DeclPtr parseFunDecl(Type returnType, const std::string &name, uint32_t begin);
 	// 
 	StmtPtr parseStmt();
 	// 
-	std::unique_ptr<CompoundStmt> parseCompoundStmt();
+	NodePtr<CompoundStmt> parseCompoundStmt();
 	// ʽ
 	ExprPtr parseExpr();
 	// ֵʽ
 	ExprPtr parseAssignmentExpr();
-	// ߼orʽ
-	ExprPtr parseLogicalOrExpr();
-	// ߼andʽ
-	ExprPtr parseLogicalAndExpr();
-	// ڱʽ
-	ExprPtr parseEqualityExpr();
-	// Ԫʽ
-	ExprPtr parseRelationalExpr();
-	// ӷʽ
-	ExprPtr parseAdditiveExpr();
-	// ˷ʽ
-	ExprPtr parseMultiplicativeExpr();
+	// ȼԪʽֻȼminPrec
+	ExprPtr parseBinaryExpr(int minPrec);
 	// һԪʽ
 	ExprPtr parseUnaryExpr();
 	// ʽ
@@ -60,6 +87,10 @@ class Parser{
 	Parser(const std::vector<Token>& tokens);
 	Parser();
 	void setTokens(const std::vector<Token>& tokens);
+	void setTokens(std::vector<Token>&& tokens);
+	// ǷProgramʱǲASTdiagnostics()
 	ProgramPtr parse();
+	const std::vector<ParseDiagnostic>& diagnostics() const { return diags; }
+	bool hasErrors() const { return !diags.empty(); }
 
 };
\ No newline at end of file
@@ -1,105 +1,377 @@
 
 #include "SemanticAnalyzer.hpp"
 
-#include <sstream>
-
-static bool isRelOp(const std::string& op) {
-	return op == "<" || op == ">" || op == "<=" || op == ">=";
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Type-checking rule of each binary operator, indexed by BinaryOp
+enum class BinaryRule : unsigned char { Arith, IntArith, Compare, Logical };
+
+constexpr BinaryRule kBinaryRules[] = {
+	BinaryRule::Arith,		// +
+	BinaryRule::Arith,		// -
+	BinaryRule::Arith,		// *
+	BinaryRule::Arith,		// /
+	BinaryRule::IntArith,	// %
+	BinaryRule::Compare,	// <
+	BinaryRule::Compare,	// >
+	BinaryRule::Compare,	// <=
+	BinaryRule::Compare,	// >=
+	BinaryRule::Compare,	// ==
+	BinaryRule::Compare,	// !=
+	BinaryRule::Logical,	// &&
+	BinaryRule::Logical,	// ||
+};
+static_assert(sizeof(kBinaryRules) / sizeof(kBinaryRules[0]) == static_cast<size_t>(BinaryOp::Or) + 1,
+              "kBinaryRules must cover every BinaryOp");
+
+BinaryRule binaryRule(BinaryOp op) {
+	return kBinaryRules[static_cast<size_t>(op)];
 }
 
-static bool isEqOp(const std::string& op) {
-	return op == "==" || op == "!=";
-}
+// Below this many function bodies the threads cost more than they save.
+constexpr size_t kMinParallelFunctions = 256;
 
-static bool isLogicalOp(const std::string& op) {
-	return op == "&&" || op == "||";
-}
+} // namespace
 
-static bool isArithOp(const std::string& op) {
-	return op == "+" || op == "-" || op == "*" || op == "/" || op == "%";
+void SemanticAnalyzer::setThreads(unsigned n) {
+	threadCount = n != 0 ? n : std::max(1u, std::thread::hardware_concurrency());
 }
 
 void SemanticAnalyzer::analyze(const Program& program) {
 	symbols.reset();
 	currentFunctionReturnType.reset();
+	nextGlobalId = 0;
+	signatures.clear();
+	freeGlobalIds.clear();
+	freeFunctionIds.clear();
+	records.assign(program.decls.size(), DeclRecord());
+	for (size_t i = 0; i < program.decls.size(); ++i) {
+		describe(records[i], program.decls[i].get());
+	}
+
+	// pass 1: declare every global (so calls before definition work)
+	declareGlobals(program);
+
+	// pass 2: function bodies and global initializers
+	std::vector<size_t> all(program.decls.size());
+	for (size_t i = 0; i < all.size(); ++i) {
+		all[i] = i;
+	}
+	complete = checkDecls(program, all);
+	collectDiagnostics(program);
+}
+
+size_t SemanticAnalyzer::reanalyze(const Program& program, size_t firstDecl, size_t removedDecls,
+                                   size_t insertedDecls) {
+	if (!complete || firstDecl + removedDecls > records.size()
+	    || records.size() - removedDecls + insertedDecls != program.decls.size()) {
+		analyze(program);
+		return program.decls.size();
+	}
+
+	std::vector<DeclRecord> fresh(insertedDecls);
+	for (size_t k = 0; k < insertedDecls; ++k) {
+		describe(fresh[k], program.decls[firstDecl + k].get());
+	}
+	auto removed = records.begin() + static_cast<std::ptrdiff_t>(firstDecl);
+	bool sameHeaders = removedDecls == insertedDecls;
+	for (size_t k = 0; sameHeaders && k < insertedDecls; ++k) {
+		sameHeaders = fresh[k].sameHeader(removed[k]);
+	}
+
+	// global names whose declaration may differ; bodies looking them up are stale
+	std::vector<NameId> changed;
+	if (sameHeaders) {
+		// only bodies changed: the global scope stays as it is
+		for (size_t k = 0; k < insertedDecls; ++k) {
+			const DeclRecord& old = removed[k];
+			fresh[k].id = old.id;
+			fresh[k].redeclared = old.redeclared;
+			fresh[k].visibleGlobals = old.visibleGlobals;
+			annotateDecl(program.decls[firstDecl + k].get(), fresh[k]);
+		}
+		std::move(fresh.begin(), fresh.end(), removed);
+	} else {
+		for (size_t k = 0; k < removedDecls; ++k) {
+			changed.push_back(removed[k].name);
+		}
+		for (DeclRecord& rec : fresh) {
+			changed.push_back(rec.name);
+			// a declaration parsed again unchanged keeps its id, so references to it stay valid
+			for (size_t k = 0; k < removedDecls; ++k) {
+				if (removed[k].id != kNoSymbol && rec.sameHeader(removed[k])) {
+					rec.id = removed[k].id;
+					removed[k].id = kNoSymbol;
+					break;
+				}
+			}
+		}
+		// ids no new declaration took over are free again; every body using
+		// one names its declaration, so it is checked again below
+		for (size_t k = 0; k < removedDecls; ++k) {
+			if (removed[k].id == kNoSymbol) continue;
+			(removed[k].kind == NodeKind::FunDecl ? freeFunctionIds : freeGlobalIds).push_back(removed[k].id);
+		}
+		removed = records.erase(removed, removed + static_cast<std::ptrdiff_t>(removedDecls));
+		records.insert(removed, std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+		declareGlobals(program);
+		std::sort(changed.begin(), changed.end());
+		changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+	}
+
+	std::vector<size_t> stale;
+	for (size_t i = 0; i < records.size(); ++i) {
+		bool edited = i >= firstDecl && i < firstDecl + insertedDecls;
+		if (edited || records[i].usesAny(changed)) {
+			stale.push_back(i);
+		}
+	}
+	complete = checkDecls(program, stale);
+	collectDiagnostics(program);
+	return stale.size();
+}
+
+bool SemanticAnalyzer::DeclRecord::sameHeader(const DeclRecord& other) const {
+	return kind == other.kind && name == other.name && type == other.type && params == other.params;
+}
+
+bool SemanticAnalyzer::DeclRecord::usesAny(const std::vector<NameId>& names) const {
+	// both sorted
+	auto a = uses.begin();
+	auto b = names.begin();
+	while (a != uses.end() && b != names.end()) {
+		if (*a < *b) ++a;
+		else if (*b < *a) ++b;
+		else return true;
+	}
+	return false;
+}
+
+void SemanticAnalyzer::describe(DeclRecord& rec, const Decl* decl) {
+	rec = DeclRecord();
+	if (auto var = dynCast<VarDecl>(decl)) {
+		rec.kind = NodeKind::VarDecl;
+		rec.name = nameOf(*var);
+		rec.type = var->type;
+	} else if (auto fun = dynCast<FunDecl>(decl)) {
+		rec.kind = NodeKind::FunDecl;
+		rec.name = nameOf(*fun);
+		rec.type = fun->returnType;
+		for (const auto& p : fun->params) {
+			if (p) rec.params.push_back(p->type);
+		}
+	}
+}
+
+void SemanticAnalyzer::annotateDecl(const Decl* decl, const DeclRecord& rec) {
+	SymbolId id = rec.redeclared ? kNoSymbol : rec.id;
+	if (auto var = dynCast<VarDecl>(decl)) var->symbol = id;
+	else if (auto fun = dynCast<FunDecl>(decl)) fun->symbol = id;
+}
 
-	// pass 1: declare all global function signatures (so calls before definition work)
-	for (const auto& declPtr : program.decls) {
-		if (!declPtr) {
+// Functions first, then the variables at their place in the source, as the
+// body checks expect. Declarations without an id get a free or new one; the
+// rest keep theirs so references recorded in unchanged bodies stay valid.
+void SemanticAnalyzer::declareGlobals(const Program& program) {
+	symbols.reset();
+	for (size_t i = 0; i < records.size(); ++i) {
+		DeclRecord& rec = records[i];
+		if (rec.kind != NodeKind::FunDecl) {
 			continue;
 		}
-		if (auto fun = dynamic_cast<const FunDecl*>(declPtr.get())) {
-			analyzeFunDeclSignature(*fun);
+		if (rec.id == kNoSymbol) {
+			// functions are numbered apart from variables, densely, so the id indexes signatures
+			if (!freeFunctionIds.empty()) {
+				rec.id = freeFunctionIds.back();
+				freeFunctionIds.pop_back();
+				signatures[rec.id] = FuncSig{rec.params};
+			} else {
+				rec.id = static_cast<SymbolId>(signatures.size());
+				signatures.push_back(FuncSig{rec.params});
+			}
+		}
+		Symbol sym;
+		sym.kind = SymbolKind::Func;
+		sym.type = rec.type;
+		sym.declOffset = program.decls[i]->begin;
+		sym.id = rec.id;
+		rec.redeclared = !symbols.declare(rec.name, sym);
+		annotateDecl(program.decls[i].get(), rec);
+	}
+	for (size_t i = 0; i < records.size(); ++i) {
+		DeclRecord& rec = records[i];
+		if (rec.kind == NodeKind::VarDecl) {
+			if (rec.id == kNoSymbol && !freeGlobalIds.empty()) {
+				rec.id = freeGlobalIds.back();
+				freeGlobalIds.pop_back();
+			} else if (rec.id == kNoSymbol) {
+				rec.id = nextGlobalId++;
+			}
+			Symbol sym;
+			sym.kind = SymbolKind::Var;
+			sym.type = rec.type;
+			sym.declOffset = program.decls[i]->begin;
+			sym.id = rec.id;
+			rec.redeclared = !symbols.declare(rec.name, sym);
+			annotateDecl(program.decls[i].get(), rec);
 		}
+		// an initializer sees its own variable, a body every global declared so far
+		rec.visibleGlobals = symbols.bindingCount();
 	}
+}
 
-	// pass 2: analyze all decls (vars + function bodies)
-	for (const auto& declPtr : program.decls) {
-		if (!declPtr) {
+// Checks the bodies and initializers of the given declarations (in source
+// order) against the frozen global scope. Returns false if it stopped early
+// because the error limit was reached.
+bool SemanticAnalyzer::checkDecls(const Program& program, const std::vector<size_t>& which) {
+	size_t bodies = 0;
+	for (size_t i : which) {
+		bodies += records[i].kind == NodeKind::FunDecl;
+	}
+	if (threadCount > 1 && bodies >= kMinParallelFunctions) {
+		checkDeclsInParallel(program, which);
+		return true;
+	}
+
+	SemanticAnalyzer worker;
+	worker.setErrorLimit(diags.errorLimit());
+	size_t errors = 0;
+	for (size_t i : which) {
+		if (errors >= diags.errorLimit()) {
+			return false;
+		}
+		if (!program.decls[i]) {
 			continue;
 		}
-		analyzeDecl(*declPtr);
+		checkDecl(worker, *program.decls[i], records[i]);
+		errors += records[i].bodyDiags.size() + records[i].redeclared;
 	}
+	return true;
 }
 
-void SemanticAnalyzer::analyzeDecl(const Decl& decl) {
-	if (auto varDecl = dynamic_cast<const VarDecl*>(&decl)) {
-		analyzeVarDecl(*varDecl, true);
-		return;
+// Pass 2 on several threads: the bodies are checked by workers, each with
+// its own scope stack in front of the frozen global scope, and every record
+// keeps its own diagnostics, so the result does not depend on which worker
+// took which declaration.
+void SemanticAnalyzer::checkDeclsInParallel(const Program& program, const std::vector<size_t>& which) {
+	std::atomic<size_t> next{0};
+	std::exception_ptr failure;
+	std::atomic<bool> failed{false};
+	auto work = [&]() {
+		SemanticAnalyzer worker;
+		worker.setErrorLimit(diags.errorLimit());
+		try {
+			for (size_t j = next++; j < which.size(); j = next++) {
+				size_t i = which[j];
+				if (program.decls[i]) {
+					checkDecl(worker, *program.decls[i], records[i]);
+				}
+			}
+		} catch (...) {
+			if (!failed.exchange(true)) failure = std::current_exception();
+			next = which.size();
+		}
+	};
+
+	size_t workers = std::min<size_t>(threadCount, which.size());
+	std::vector<std::thread> pool;
+	pool.reserve(workers > 0 ? workers - 1 : 0);
+	for (size_t t = 1; t < workers; ++t) pool.emplace_back(work);
+	work();
+	for (auto& th : pool) th.join();
+	if (failure) std::rethrow_exception(failure);
+}
+
+void SemanticAnalyzer::checkDecl(SemanticAnalyzer& worker, const Decl& decl, DeclRecord& rec) const {
+	worker.symbols.setOuter(&symbols, rec.visibleGlobals);
+	worker.outerSignatures = &signatures;
+	rec.uses.clear();
+	worker.currentUses = &rec.uses;
+	if (auto fun = dynCast<FunDecl>(&decl)) {
+		worker.analyzeFunDeclBody(*fun);
+	} else if (auto var = dynCast<VarDecl>(&decl)) {
+		worker.checkVarInit(*var);
+	}
+	worker.currentUses = nullptr;
+	rec.bodyDiags = worker.diags.take();
+	rec.begin = decl.begin;
+	std::sort(rec.uses.begin(), rec.uses.end());
+	rec.uses.erase(std::unique(rec.uses.begin(), rec.uses.end()), rec.uses.end());
+}
+
+// Same order as a single walk would report: redeclared functions (pass 1),
+// then each declaration in turn. Diagnostics recorded before an edit moved
+// their declaration are shifted with it.
+void SemanticAnalyzer::collectDiagnostics(const Program& program) {
+	diags.clear();
+	for (size_t i = 0; i < records.size(); ++i) {
+		if (records[i].kind == NodeKind::FunDecl && records[i].redeclared) {
+			const auto& fun = static_cast<const FunDecl&>(*program.decls[i]);
+			diags.report(DiagCode::RedeclaredFunction, fun, {fun.name});
+		}
 	}
-	if (auto funDecl = dynamic_cast<const FunDecl*>(&decl)) {
-		// signature already declared in pass 1
-		analyzeFunDeclBody(*funDecl);
-		return;
+	for (size_t i = 0; i < records.size(); ++i) {
+		const DeclRecord& rec = records[i];
+		if (rec.kind == NodeKind::VarDecl && rec.redeclared) {
+			const auto& var = static_cast<const VarDecl&>(*program.decls[i]);
+			diags.report(DiagCode::RedeclaredVar, var, {var.name});
+		}
+		if (rec.bodyDiags.empty()) {
+			continue;
+		}
+		uint32_t delta = program.decls[i]->begin - rec.begin;
+		for (Diagnostic d : rec.bodyDiags) {
+			if (d.end > 0) {
+				d.begin += delta;
+				d.end += delta;
+			}
+			diags.add(std::move(d));
+		}
 	}
-	// unknown decl type
 }
 
-void SemanticAnalyzer::analyzeVarDecl(const VarDecl& decl, bool /*isGlobal*/) {
+SymbolId SemanticAnalyzer::newSymbolId(bool isGlobal) {
+	return isGlobal ? nextGlobalId++ : (nextLocalId++ | kLocalSymbol);
+}
+
+void SemanticAnalyzer::analyzeVarDecl(const VarDecl& decl) {
 	Symbol sym;
 	sym.kind = SymbolKind::Var;
 	sym.type = decl.type;
-	sym.declLine = decl.line;
-	sym.declCol = decl.col;
+	sym.declOffset = decl.begin;
+	sym.id = newSymbolId(false);
 
-	if (!symbols.declare(decl.name, sym)) {
-		errorAt(decl, "ظʶ: " + decl.name);
+	// the first declaration stays in effect
+	decl.symbol = sym.id;
+	if (!symbols.declare(nameOf(decl), std::move(sym))) {
+		decl.symbol = kNoSymbol;
+		diags.report(DiagCode::RedeclaredVar, decl, {decl.name});
 	}
+	checkVarInit(decl);
+}
 
+void SemanticAnalyzer::checkVarInit(const VarDecl& decl) {
 	if (decl.init) {
 		Type initType = analyzeExpr(*decl.init);
 		if (!canWiden(initType, decl.type)) {
-			std::ostringstream oss;
-			oss << "ʼͲ:  '" << decl.name << "' Ϊ " << typeName(decl.type)
-			    << ", ʼʽΪ " << typeName(initType);
-			errorAt(decl, oss.str());
+			diags.report(DiagCode::InitTypeMismatch, decl, {decl.name, typeName(decl.type), typeName(initType)});
 		}
 	}
 }
 
-void SemanticAnalyzer::analyzeFunDeclSignature(const FunDecl& decl) {
-	Symbol sym;
-	sym.kind = SymbolKind::Func;
-	sym.type = decl.returnType;
-	sym.func.returnType = decl.returnType;
-	sym.declLine = decl.line;
-	sym.declCol = decl.col;
-	for (const auto& p : decl.params) {
-		if (!p) {
-			continue;
-		}
-		sym.func.paramTypes.push_back(p->type);
-	}
-
-	if (!symbols.declare(decl.name, sym)) {
-		errorAt(decl, "ظ: " + decl.name);
-	}
-}
-
 void SemanticAnalyzer::analyzeFunDeclBody(const FunDecl& decl) {
 	// enter function scope
 	symbols.enterScope();
 	currentFunctionReturnType = decl.returnType;
+	nextLocalId = 0;
 
 	// declare params
 	for (const auto& p : decl.params) {
@@ -109,10 +381,12 @@ void SemanticAnalyzer::analyzeFunDeclBody(const FunDecl& decl) {
 		Symbol sym;
 		sym.kind = SymbolKind::Param;
 		sym.type = p->type;
-		sym.declLine = p->line;
-		sym.declCol = p->col;
-		if (!symbols.declare(p->name, sym)) {
-			errorAt(*p, "ظβ: " + p->name);
+		sym.declOffset = p->begin;
+		sym.id = newSymbolId(false);
+		p->symbol = sym.id;
+		if (!symbols.declare(nameOf(*p), std::move(sym))) {
+			p->symbol = kNoSymbol;
+			diags.report(DiagCode::RedeclaredParam, *p, {p->name});
 		}
 	}
 
@@ -120,36 +394,35 @@ void SemanticAnalyzer::analyzeFunDeclBody(const FunDecl& decl) {
 		analyzeCompound(*decl.body);
 	}
 
+	decl.localCount = nextLocalId;
 	currentFunctionReturnType.reset();
 	symbols.leaveScope();
 }
 
 void SemanticAnalyzer::analyzeStmt(const Stmt& stmt) {
-	if (auto compound = dynamic_cast<const CompoundStmt*>(&stmt)) {
-		analyzeCompound(*compound);
-		return;
-	}
-	if (auto ifStmt = dynamic_cast<const IfStmt*>(&stmt)) {
-		analyzeIf(*ifStmt);
-		return;
-	}
-	if (auto whileStmt = dynamic_cast<const WhileStmt*>(&stmt)) {
-		analyzeWhile(*whileStmt);
-		return;
-	}
-	if (auto forStmt = dynamic_cast<const ForStmt*>(&stmt)) {
-		analyzeFor(*forStmt);
-		return;
-	}
-	if (auto retStmt = dynamic_cast<const ReturnStmt*>(&stmt)) {
-		analyzeReturn(*retStmt);
-		return;
-	}
-	if (auto exprStmt = dynamic_cast<const ExprStmt*>(&stmt)) {
-		analyzeExprStmt(*exprStmt);
-		return;
+	switch (stmt.kind) {
+		case NodeKind::CompoundStmt:
+			analyzeCompound(static_cast<const CompoundStmt&>(stmt));
+			return;
+		case NodeKind::IfStmt:
+			analyzeIf(static_cast<const IfStmt&>(stmt));
+			return;
+		case NodeKind::WhileStmt:
+			analyzeWhile(static_cast<const WhileStmt&>(stmt));
+			return;
+		case NodeKind::ForStmt:
+			analyzeFor(static_cast<const ForStmt&>(stmt));
+			return;
+		case NodeKind::ReturnStmt:
+			analyzeReturn(static_cast<const ReturnStmt&>(stmt));
+			return;
+		case NodeKind::ExprStmt:
+			analyzeExprStmt(static_cast<const ExprStmt&>(stmt));
+			return;
+		default:
+			// unknown stmt type
+			return;
 	}
-	// unknown stmt type
 }
 
 void SemanticAnalyzer::analyzeCompound(const CompoundStmt& stmt) {
@@ -159,9 +432,12 @@ void SemanticAnalyzer::analyzeCompound(const CompoundStmt& stmt) {
 		if (!v) {
 			continue;
 		}
-		analyzeVarDecl(*v, false);
+		analyzeVarDecl(*v);
 	}
 	for (const auto& s : stmt.stmts) {
+		if (diags.full()) {
+			break;
+		}
 		if (!s) {
 			continue;
 		}
@@ -173,11 +449,9 @@ void SemanticAnalyzer::analyzeCompound(const CompoundStmt& stmt) {
 
 void SemanticAnalyzer::analyzeIf(const IfStmt& stmt) {
 	if (!stmt.cond) {
-		errorAt(stmt, "if ȱʧ");
-	}
-	Type condType = analyzeExpr(*stmt.cond);
-	if (condType == Type::VOID) {
-		errorAt(stmt, "if Ϊ void");
+		diags.report(DiagCode::MissingIfCond, stmt);
+	} else if (analyzeExpr(*stmt.cond) == Type::VOID) {
+		diags.report(DiagCode::VoidIfCond, stmt);
 	}
 	if (stmt.thenBranch) {
 		analyzeStmt(*stmt.thenBranch);
@@ -189,11 +463,9 @@ void SemanticAnalyzer::analyzeIf(const IfStmt& stmt) {
 
 void SemanticAnalyzer::analyzeWhile(const WhileStmt& stmt) {
 	if (!stmt.cond) {
-		errorAt(stmt, "while ȱʧ");
-	}
-	Type condType = analyzeExpr(*stmt.cond);
-	if (condType == Type::VOID) {
-		errorAt(stmt, "while Ϊ void");
+		diags.report(DiagCode::MissingWhileCond, stmt);
+	} else if (analyzeExpr(*stmt.cond) == Type::VOID) {
+		diags.report(DiagCode::VoidWhileCond, stmt);
 	}
 	if (stmt.body) {
 		analyzeStmt(*stmt.body);
@@ -208,7 +480,7 @@ void SemanticAnalyzer::analyzeFor(const ForStmt& stmt) {
 	if (stmt.cond) {
 		Type condType = analyzeExpr(*stmt.cond);
 		if (condType == Type::VOID) {
-			errorAt(stmt, "for Ϊ void");
+			diags.report(DiagCode::VoidForCond, stmt);
 		}
 	}
 	if (stmt.update) {
@@ -221,23 +493,24 @@ void SemanticAnalyzer::analyzeFor(const ForStmt& stmt) {
 
 void SemanticAnalyzer::analyzeReturn(const ReturnStmt& stmt) {
 	if (!currentFunctionReturnType.has_value()) {
-		errorAt(stmt, "return ֻܳں");
+		diags.report(DiagCode::ReturnOutsideFunction, stmt);
+		return;
 	}
 	Type expected = *currentFunctionReturnType;
 	if (expected == Type::VOID) {
 		if (stmt.expr) {
-			errorAt(stmt, "void Ӧֵ");
+			diags.report(DiagCode::ReturnValueInVoid, stmt);
+			(void)analyzeExpr(*stmt.expr);
 		}
 		return;
 	}
 	if (!stmt.expr) {
-		errorAt(stmt, " void 뷵ֵ");
+		diags.report(DiagCode::MissingReturnValue, stmt);
+		return;
 	}
 	Type actual = analyzeExpr(*stmt.expr);
 	if (!canWiden(actual, expected)) {
-		std::ostringstream oss;
-		oss << "return Ͳƥ:  " << typeName(expected) << ", ʵ " << typeName(actual);
-		errorAt(stmt, oss.str());
+		diags.report(DiagCode::ReturnTypeMismatch, stmt, {typeName(expected), typeName(actual)});
 	}
 }
 
@@ -250,139 +523,165 @@ void SemanticAnalyzer::analyzeExprStmt(const ExprStmt& stmt) {
 }
 
 Type SemanticAnalyzer::analyzeExpr(const Expr& expr) {
-	if (auto a = dynamic_cast<const AssignExpr*>(&expr)) return analyzeAssignExpr(*a);
-	if (auto b = dynamic_cast<const BinaryExpr*>(&expr)) return analyzeBinaryExpr(*b);
-	if (auto u = dynamic_cast<const UnaryExpr*>(&expr)) return analyzeUnaryExpr(*u);
-	if (auto c = dynamic_cast<const CallExpr*>(&expr)) return analyzeCallExpr(*c);
-	if (auto v = dynamic_cast<const ValExpr*>(&expr)) return analyzeValExpr(*v);
-	if (auto i = dynamic_cast<const IntLiteral*>(&expr)) return analyzeIntLiteral(*i);
-	if (auto ch = dynamic_cast<const CharLiteral*>(&expr)) return analyzeCharLiteral(*ch);
-	if (auto d = dynamic_cast<const DoubleLiteral*>(&expr)) return analyzeDoubleLiteral(*d);
-	// unknown expr
-	return Type::VOID;
+	Type t = Type::VOID;	// unknown expr
+	switch (expr.kind) {
+		case NodeKind::AssignExpr: t = analyzeAssignExpr(static_cast<const AssignExpr&>(expr)); break;
+		case NodeKind::BinaryExpr: t = analyzeBinaryExpr(static_cast<const BinaryExpr&>(expr)); break;
+		case NodeKind::UnaryExpr: t = analyzeUnaryExpr(static_cast<const UnaryExpr&>(expr)); break;
+		case NodeKind::CallExpr: t = analyzeCallExpr(static_cast<const CallExpr&>(expr)); break;
+		case NodeKind::ValExpr: t = analyzeValExpr(static_cast<const ValExpr&>(expr)); break;
+		case NodeKind::IntLiteral: t = analyzeIntLiteral(static_cast<const IntLiteral&>(expr)); break;
+		case NodeKind::CharLiteral: t = analyzeCharLiteral(static_cast<const CharLiteral&>(expr)); break;
+		case NodeKind::DoubleLiteral: t = analyzeDoubleLiteral(static_cast<const DoubleLiteral&>(expr)); break;
+		default: break;
+	}
+	expr.resolvedType = t;
+	return t;
 }
 
 Type SemanticAnalyzer::analyzeAssignExpr(const AssignExpr& expr) {
 	if (!expr.left || !expr.right) {
-		errorAt(expr, "ֵʽ");
+		diags.report(DiagCode::IncompleteAssign, expr);
+		return Type::ERROR;
 	}
 	// ֵȰСҪֻΪֵչ *p ȣ
-	auto lhsVar = dynamic_cast<const ValExpr*>(expr.left.get());
+	auto lhsVar = dynCast<ValExpr>(expr.left.get());
 	if (!lhsVar) {
-		errorAt(expr, "ֵǱʶǰֵָ֧");
+		diags.report(DiagCode::AssignTargetNotVar, expr);
+		(void)analyzeExpr(*expr.right);
+		return Type::ERROR;
 	}
 	Type lhsType = analyzeValExpr(*lhsVar);
+	lhsVar->resolvedType = lhsType;
 	Type rhsType = analyzeExpr(*expr.right);
 	if (!canWiden(rhsType, lhsType)) {
-		std::ostringstream oss;
-		oss << "ֵͲ:  " << typeName(lhsType) << ", Ҳ " << typeName(rhsType);
-		errorAt(expr, oss.str());
+		diags.report(DiagCode::AssignTypeMismatch, expr, {typeName(lhsType), typeName(rhsType)});
 	}
 	return lhsType;
 }
 
 Type SemanticAnalyzer::analyzeBinaryExpr(const BinaryExpr& expr) {
 	if (!expr.left || !expr.right) {
-		errorAt(expr, "Ԫʽ");
+		diags.report(DiagCode::IncompleteBinary, expr);
+		return Type::ERROR;
 	}
 	Type lt = analyzeExpr(*expr.left);
 	Type rt = analyzeExpr(*expr.right);
-	const std::string& op = expr.op;
+	// an operand already reported; don't pile a second error on top
+	if (lt == Type::ERROR || rt == Type::ERROR) {
+		return Type::ERROR;
+	}
+	const BinaryRule rule = binaryRule(expr.op);
 
-	if (isLogicalOp(op)) {
+	if (rule == BinaryRule::Logical) {
 		if (lt == Type::VOID || rt == Type::VOID) {
-			errorAt(expr, "߼಻Ϊ void");
+			diags.report(DiagCode::VoidLogicalOperand, expr);
 		}
 		return Type::INT;
 	}
-	if (isRelOp(op) || isEqOp(op)) {
+	if (rule == BinaryRule::Compare) {
 		if (!isNumeric(lt) || !isNumeric(rt)) {
-			errorAt(expr, "ȽҪֵ");
+			diags.report(DiagCode::NonNumericCompare, expr);
 		}
 		return Type::INT;
 	}
-	if (isArithOp(op)) {
-		if (!isNumeric(lt) || !isNumeric(rt)) {
-			errorAt(expr, "Ҫֵ");
-		}
-		if (op == "%") {
-			// ȡģֻ
-			Type ct = commonNumericType(lt, rt);
-			if (ct == Type::DOUBLE) {
-				errorAt(expr, "ȡģ㲻֧ double");
-			}
-			return Type::INT;
+	if (!isNumeric(lt) || !isNumeric(rt)) {
+		diags.report(DiagCode::NonNumericArith, expr);
+		return Type::ERROR;
+	}
+	if (rule == BinaryRule::IntArith) {
+		// ȡģֻ
+		Type ct = commonNumericType(lt, rt);
+		if (ct == Type::DOUBLE) {
+			diags.report(DiagCode::DoubleModulo, expr);
 		}
-		return commonNumericType(lt, rt);
+		return Type::INT;
 	}
-
-	// unknown operator
-	return Type::VOID;
+	return commonNumericType(lt, rt);
 }
 
 Type SemanticAnalyzer::analyzeUnaryExpr(const UnaryExpr& expr) {
 	if (!expr.operand) {
-		errorAt(expr, "һԪʽȱٲ");
+		diags.report(DiagCode::MissingOperand, expr);
+		return Type::ERROR;
 	}
 	Type ot = analyzeExpr(*expr.operand);
-	const std::string& op = expr.op;
-	if (op == "!") {
-		if (ot == Type::VOID) {
-			errorAt(expr, "! 㲻֧ void");
-		}
-		return Type::INT;
-	}
-	if (op == "+" || op == "-") {
-		if (!isNumeric(ot)) {
-			errorAt(expr, "һԪ +/- Ҫֵ");
-		}
-		// char Ϊ int
-		if (ot == Type::CHAR) return Type::INT;
-		return ot;
+	if (ot == Type::ERROR) {
+		return Type::ERROR;
 	}
-	if (op == "*") {
-		//  C Ӽ˵úδ壬ﲻƵֱ͸
-		return ot;
+	switch (expr.op) {
+		case UnaryOp::Not:
+			if (ot == Type::VOID) {
+				diags.report(DiagCode::VoidNotOperand, expr);
+			}
+			return Type::INT;
+		case UnaryOp::Plus:
+		case UnaryOp::Minus:
+			if (!isNumeric(ot)) {
+				diags.report(DiagCode::NonNumericSign, expr);
+				return Type::ERROR;
+			}
+			// char Ϊ int
+			if (ot == Type::CHAR) return Type::INT;
+			return ot;
+		case UnaryOp::Deref:
+			//  C Ӽ˵úδ壬ﲻƵֱ͸
+			return ot;
 	}
 	return Type::VOID;
 }
 
 Type SemanticAnalyzer::analyzeCallExpr(const CallExpr& expr) {
-	const Symbol* sym = symbols.lookup(expr.name);
+	NameId name = nameOf(expr);
+	const Symbol* sym = symbols.lookup(name);
+	noteGlobalUse(name, sym);
+	expr.symbol = kNoSymbol;
 	if (!sym || sym->kind != SymbolKind::Func) {
-		errorAt(expr, "δĺ: " + expr.name);
+		diags.report(DiagCode::UndeclaredFunction, expr, {expr.name});
+		// still check the arguments for errors of their own
+		for (const auto& arg : expr.args) {
+			if (arg) (void)analyzeExpr(*arg);
+		}
+		return Type::ERROR;
 	}
-	const auto& paramTypes = sym->func.paramTypes;
+	expr.symbol = sym->id;
+	const auto& paramTypes = signatureOf(*sym).paramTypes;
 	if (expr.args.size() != paramTypes.size()) {
-		std::ostringstream oss;
-		oss << " '" << expr.name << "' ƥ:  " << paramTypes.size() << ", ʵ "
-		    << expr.args.size();
-		errorAt(expr, oss.str());
+		diags.report(DiagCode::ArgCountMismatch, expr,
+		             {expr.name, std::to_string(paramTypes.size()), std::to_string(expr.args.size())});
 	}
 	for (size_t i = 0; i < expr.args.size(); ++i) {
 		if (!expr.args[i]) {
-			errorAt(expr, "Ϊ");
+			diags.report(DiagCode::NullArgument, expr);
+			continue;
 		}
 		Type actual = analyzeExpr(*expr.args[i]);
+		if (i >= paramTypes.size()) {
+			continue;
+		}
 		Type expected = paramTypes[i];
 		if (!canWiden(actual, expected)) {
-			std::ostringstream oss;
-			oss << " '" << expr.name << "'  " << (i + 1)
-			    << " Ͳƥ:  " << typeName(expected) << ", ʵ " << typeName(actual);
-			errorAt(expr, oss.str());
+			diags.report(DiagCode::ArgTypeMismatch, expr,
+			             {expr.name, std::to_string(i + 1), typeName(expected), typeName(actual)});
 		}
 	}
-	return sym->func.returnType;
+	return sym->type;
 }
 
 Type SemanticAnalyzer::analyzeValExpr(const ValExpr& expr) {
-	const Symbol* sym = symbols.lookup(expr.name);
+	NameId name = nameOf(expr);
+	const Symbol* sym = symbols.lookup(name);
+	noteGlobalUse(name, sym);
+	expr.symbol = kNoSymbol;
 	if (!sym) {
-		errorAt(expr, "δıʶ: " + expr.name);
+		diags.report(DiagCode::UndeclaredIdentifier, expr, {expr.name});
+		return Type::ERROR;
 	}
 	if (sym->kind == SymbolKind::Func) {
-		errorAt(expr, "ܵʹ: " + expr.name);
+		diags.report(DiagCode::FunctionAsVariable, expr, {expr.name});
+		return Type::ERROR;
 	}
+	expr.symbol = sym->id;
 	return sym->type;
 }
 
@@ -426,6 +725,8 @@ Type SemanticAnalyzer::commonNumericType(Type a, Type b) {
 
 bool SemanticAnalyzer::canWiden(Type from, Type to) {
 	if (from == to) return true;
+	// the error behind an ERROR operand has already been reported
+	if (from == Type::ERROR || to == Type::ERROR) return true;
 	if (from == Type::VOID || to == Type::VOID) return false;
 	// numeric promotion: char -> int -> double
 	if (from == Type::CHAR && (to == Type::INT || to == Type::DOUBLE)) return true;
@@ -436,14 +737,3 @@ bool SemanticAnalyzer::canWiden(Type from, Type to) {
 std::string SemanticAnalyzer::typeName(Type t) {
 	return typeToString(t);
 }
-
-[[noreturn]] void SemanticAnalyzer::errorAt(const ASTNode& node, const std::string& msg) const {
-	std::ostringstream oss;
-	if (node.line > 0) {
-		oss << "( " << node.line << ",  " << node.col << "): ";
-	} else {
-		oss << ": ";
-	}
-	oss << msg;
-	throw SemanticError(oss.str());
-}
@@ -1,29 +1,99 @@
 #pragma once
 
 #include "AST.hpp"
+#include "Diagnostics.hpp"
 #include "SymbolTable.hpp"
 
 #include <optional>
-#include <stdexcept>
 #include <string>
+#include <vector>
 
-class SemanticError : public std::runtime_error {
-public:
-	explicit SemanticError(const std::string& msg) : std::runtime_error(msg) {}
-};
-
+// Type-checks a whole program without stopping at the first error: each
+// problem goes to the diagnostics sink and the offending expression gets
+// Type::ERROR, which later checks accept silently so one mistake is
+// reported once.
+//
+// The results are left on the tree for later passes: every Expr gets its
+// resolvedType, names and calls the SymbolId of their declaration, and
+// declarations the id they were given (see SymbolId in AST.hpp).
+//
+// For editors, analyze() also remembers per top-level declaration its
+// header, the global names its body looked up and its diagnostics, so that
+// reanalyze() can follow an IncrementalParser edit by checking only the
+// replaced declarations and the bodies that use a global whose declaration
+// changed. Editing inside a body re-checks that body alone. The rest
+// still takes a pass over every record: finding the bodies that use a
+// changed global, gathering the diagnostics in source order, and, when a
+// header changed, declaring the globals again. Each is cheap per
+// declaration, but linear in the file rather than in the edit.
 class SemanticAnalyzer {
 public:
 	SemanticAnalyzer() = default;
 	void analyze(const Program& program);
+	// After decls [firstDecl, firstDecl + removedDecls) of the analyzed
+	// program were replaced by insertedDecls new ones (see ReparseResult).
+	// Falls back to analyze() if the records don't fit. Returns the number
+	// of declarations checked again.
+	size_t reanalyze(const Program& program, size_t firstDecl, size_t removedDecls, size_t insertedDecls);
+	// errors of the last analyze() or reanalyze(), in source order
+	const DiagnosticSink& diagnostics() const { return diags; }
+	bool hasErrors() const { return !diags.empty(); }
+	// analysis stops once this many errors are recorded
+	void setErrorLimit(size_t n) { diags.setLimit(n); }
+	// threads for checking function bodies; 0 uses hardware_concurrency()
+	void setThreads(unsigned n);
 
 private:
+	// What a top-level declaration looked like when last checked.
+	struct DeclRecord {
+		NodeKind kind = NodeKind::Program;	// VarDecl, FunDecl, or Program for a null entry
+		NameId name = kNoName;
+		Type type = Type::VOID;
+		std::vector<Type> params;		// functions only
+		SymbolId id = kNoSymbol;
+		bool redeclared = false;		// lost to an earlier global of the same name
+		uint32_t visibleGlobals = 0;	// global bindings in scope for the body or initializer
+		uint32_t begin = 0;				// decl->begin when bodyDiags were recorded
+		std::vector<NameId> uses;		// sorted; global or undeclared names looked up
+		std::vector<Diagnostic> bodyDiags;
+
+		bool sameHeader(const DeclRecord& other) const;
+		bool usesAny(const std::vector<NameId>& names) const;
+	};
+
 	SymbolTable symbols;
+	DiagnosticSink diags;
 	std::optional<Type> currentFunctionReturnType;
+	uint32_t nextGlobalId = 0;
+	uint32_t nextLocalId = 0;	// within the function being checked
+	std::vector<FuncSig> signatures;	// by function SymbolId
+	// ids of declarations reanalyze() dropped, handed out before new ones
+	std::vector<SymbolId> freeGlobalIds, freeFunctionIds;
+	// a worker reads the signatures of the analyzer that started it
+	const std::vector<FuncSig>* outerSignatures = nullptr;
+	unsigned threadCount = 1;
+	std::vector<DeclRecord> records;	// parallel to Program::decls
+	bool complete = false;				// every record was checked
+	std::vector<NameId>* currentUses = nullptr;
 
-	void analyzeDecl(const Decl& decl);
-	void analyzeVarDecl(const VarDecl& decl, bool isGlobal);
-	void analyzeFunDeclSignature(const FunDecl& decl);
+	static void describe(DeclRecord& rec, const Decl* decl);
+	static void annotateDecl(const Decl* decl, const DeclRecord& rec);
+	void declareGlobals(const Program& program);
+	bool checkDecls(const Program& program, const std::vector<size_t>& which);
+	void checkDeclsInParallel(const Program& program, const std::vector<size_t>& which);
+	void checkDecl(SemanticAnalyzer& worker, const Decl& decl, DeclRecord& rec) const;
+	void collectDiagnostics(const Program& program);
+	void noteGlobalUse(NameId name, const Symbol* sym) {
+		if (currentUses && (!sym || !isLocalSymbol(sym->id))) currentUses->push_back(name);
+	}
+
+	SymbolId newSymbolId(bool isGlobal);
+	const FuncSig& signatureOf(const Symbol& fun) const {
+		return (outerSignatures ? *outerSignatures : signatures)[fun.id];
+	}
+
+	void analyzeVarDecl(const VarDecl& decl);
+	void checkVarInit(const VarDecl& decl);
 	void analyzeFunDeclBody(const FunDecl& decl);
 
 	void analyzeStmt(const Stmt& stmt);
@@ -44,12 +114,16 @@ private:
 	Type analyzeCharLiteral(const CharLiteral& expr);
 	Type analyzeDoubleLiteral(const DoubleLiteral& expr);
 
+	// nodes built without the Parser may not carry an id yet
+	template<class T>
+	static NameId nameOf(const T& node) {
+		return node.nameId != kNoName ? node.nameId : identifiers().intern(node.name);
+	}
+
 	static bool isNumeric(Type t);
 	static int numericRank(Type t);
 	static Type commonNumericType(Type a, Type b);
 	static bool canWiden(Type from, Type to);
 	static std::string typeName(Type t);
-
-	[[noreturn]] void errorAt(const ASTNode& node, const std::string& msg) const;
 };
 
@@ -1,54 +1,69 @@
 #include "SymbolTable.hpp"
 
+#include <utility>
+
 SymbolTable::SymbolTable() {
 	reset();
 }
 
 void SymbolTable::reset() {
-	scopes.clear();
+	// unwind through the binding stack: only names bound right now are touched
+	while (!scopeStarts.empty()) {
+		leaveScope();
+	}
 	enterScope(); // global
 }
 
 void SymbolTable::enterScope() {
-	scopes.emplace_back();
+	scopeStarts.push_back(static_cast<uint32_t>(bindings.size()));
 }
 
 void SymbolTable::leaveScope() {
-	if (scopes.empty()) {
+	if (scopeStarts.empty()) {
 		return;
 	}
-	scopes.pop_back();
+	// pop this scope's bindings, uncovering what they shadowed
+	while (bindings.size() > scopeStarts.back()) {
+		const Binding& b = bindings.back();
+		visible[b.name] = b.shadowed;
+		bindings.pop_back();
+	}
+	scopeStarts.pop_back();
 }
 
-bool SymbolTable::declare(const std::string& name, const Symbol& sym) {
-	if (scopes.empty()) {
+bool SymbolTable::declare(NameId name, Symbol sym) {
+	if (scopeStarts.empty()) {
 		enterScope();
 	}
-	auto& table = scopes.back().table;
-	if (table.find(name) != table.end()) {
+	if (name >= visible.size()) {
+		visible.resize(name + 1, kNoBinding);
+	}
+	uint32_t prev = visible[name];
+	if (prev != kNoBinding && prev >= scopeStarts.back()) {
 		return false;
 	}
-	table.emplace(name, sym);
+	visible[name] = static_cast<uint32_t>(bindings.size());
+	bindings.push_back(Binding{name, prev, std::move(sym)});
 	return true;
 }
 
-const Symbol* SymbolTable::lookupCurrent(const std::string& name) const {
-	if (scopes.empty()) {
+const Symbol* SymbolTable::lookupCurrent(NameId name) const {
+	uint32_t b = visibleBinding(name);
+	if (b == kNoBinding || scopeStarts.empty() || b < scopeStarts.back()) {
 		return nullptr;
 	}
-	const auto& table = scopes.back().table;
-	auto it = table.find(name);
-	if (it == table.end()) {
-		return nullptr;
-	}
-	return &it->second;
+	return &bindings[b].sym;
 }
 
-const Symbol* SymbolTable::lookup(const std::string& name) const {
-	for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-		auto found = it->table.find(name);
-		if (found != it->table.end()) {
-			return &found->second;
+const Symbol* SymbolTable::lookup(NameId name) const {
+	uint32_t b = visibleBinding(name);
+	if (b != kNoBinding) {
+		return &bindings[b].sym;
+	}
+	if (outer) {
+		b = outer->visibleBinding(name);
+		if (b != kNoBinding && b < outerLimit) {
+			return &outer->bindings[b].sym;
 		}
 	}
 	return nullptr;
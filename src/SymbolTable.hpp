@@ -1,32 +1,55 @@
 #pragma once
+#include <cstdint>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "AST.hpp"
+#include "Interner.hpp"
 
-enum class SymbolKind { Var, Func, Param };
+enum class SymbolKind : unsigned char { Var, Func, Param };
 
+// Parameter list of a function. Kept out of Symbol, in a table indexed by
+// the function's SymbolId, so that the far more numerous variable and
+// parameter entries stay small and trivially copyable.
 struct FuncSig {
-	Type returnType = Type::VOID;
 	std::vector<Type> paramTypes;
 };
 
 struct Symbol {
 	SymbolKind kind = SymbolKind::Var;
-	Type type = Type::VOID;
-	FuncSig func;
-	int declLine = 0;
-	int declCol = 0;
-};
-
-struct Scope {
-	std::unordered_map<std::string, Symbol> table;
+	Type type = Type::VOID;		// a function's return type
+	uint32_t declOffset = 0;	// source offset of the declaring node
+	SymbolId id = kNoSymbol;	// number written into the AST by the analyzer
 };
 
+// Scoped symbols indexed by NameId. visible[id] is the binding the name
+// currently resolves to; bindings form a stack in declaration order and
+// each remembers the outer binding it shadows, restored when its scope is
+// left. A lookup is one array access at any nesting depth, with no hashing,
+// and entering or leaving a scope allocates nothing once the vectors have
+// grown: the binding stack doubles as the undo log.
 class SymbolTable {
 private:
-	std::vector<Scope> scopes;
+	static constexpr uint32_t kNoBinding = 0xFFFFFFFFu;
+
+	struct Binding {
+		NameId name;
+		uint32_t shadowed;	// outer binding of the same name, or kNoBinding
+		Symbol sym;
+	};
+
+	std::vector<uint32_t> visible;		// by NameId
+	std::vector<Binding> bindings;
+	std::vector<uint32_t> scopeStarts;	// first binding of each open scope
+
+	// searched for names with no binding here; only its first outerLimit
+	// bindings are visible
+	const SymbolTable* outer = nullptr;
+	uint32_t outerLimit = 0;
+
+	uint32_t visibleBinding(NameId name) const {
+		return name < visible.size() ? visible[name] : kNoBinding;
+	}
 
 public:
 	SymbolTable();
@@ -35,7 +58,17 @@ public:
 	void enterScope();
 	void leaveScope();
 
-	bool declare(const std::string& name, const Symbol& sym);
-	const Symbol* lookup(const std::string& name) const;
-	const Symbol* lookupCurrent(const std::string& name) const;
+	bool declare(NameId name, Symbol sym);
+	// returned pointers stay valid until the next declare
+	const Symbol* lookup(NameId name) const;
+	const Symbol* lookupCurrent(NameId name) const;
+
+	// Makes the first `limit` bindings of a frozen table visible behind this
+	// one, e.g. the globals declared before a function, so function bodies
+	// can be checked on other threads against a shared global scope.
+	void setOuter(const SymbolTable* table, uint32_t limit) {
+		outer = table;
+		outerLimit = limit;
+	}
+	uint32_t bindingCount() const { return static_cast<uint32_t>(bindings.size()); }
 };
\ No newline at end of file
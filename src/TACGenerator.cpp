@@ -2,92 +2,184 @@
 
 #include <stdexcept>
 
-void TACGenerator::reset() {
-	tempCounter = 0;
-	labelCounter = 0;
-	out.str(std::string());
-	out.clear();
+void TACGenerator::reset(TacModule& m) {
+	module = &m;
+	fn = nullptr;
 }
 
-std::string TACGenerator::newTemp() {
-	return "t" + std::to_string(++tempCounter);
+TacOperand TACGenerator::newTemp() {
+	return TacOperand::temp(++module->tempCount);
 }
 
-std::string TACGenerator::newLabel() {
-	return "L" + std::to_string(++labelCounter);
+TacOperand TACGenerator::newLabel() {
+	return TacOperand::label(++module->labelCount);
 }
 
-void TACGenerator::emit(const std::string& line) {
-	out << line << "\n";
+TacOperand TACGenerator::constant(Type type, const std::string& text) {
+	fn->consts.push_back(TacConst{type, text});
+	return TacOperand::constant(static_cast<uint32_t>(fn->consts.size() - 1));
 }
 
-void TACGenerator::emitLabel(const std::string& label) {
-	out << label << ":\n";
+TacOperand TACGenerator::var(SymbolId symbol, const std::string& name) {
+	// дصķűţδʧܵ
+	if (symbol == kNoSymbol) {
+		throw std::runtime_error("TACGen: unresolved name " + name);
+	}
+	return TacOperand::var(symbol);
+}
+
+void TACGenerator::emit(TacOp op, Type type, TacOperand dst, TacOperand a, TacOperand b) {
+	fn->code.push_back(TacInstr{op, type, dst, a, b});
+}
+
+void TACGenerator::emitLabel(TacOperand label) {
+	emit(TacOp::Label, Type::VOID, {}, label);
 }
 
 std::string TACGenerator::generate(const Program& program) {
-	reset();
+	return printTac(build(program));
+}
+
+TacModule TACGenerator::build(const Program& program) {
+	TacModule m;
+	reset(m);
+	declareGlobals(program);
 	for (const auto& d : program.decls) {
 		if (!d) continue;
 		genDecl(*d);
 	}
-	return out.str();
+	module = nullptr;
+	fn = nullptr;
+	return m;
 }
 
-void TACGenerator::genDecl(const Decl& decl) {
-	if (auto v = dynamic_cast<const VarDecl*>(&decl)) {
-		genVarDecl(*v);
-		return;
+// ȫֱͺűŽֱֻ
+void TACGenerator::declareGlobals(const Program& program) {
+	for (const auto& d : program.decls) {
+		if (!d) continue;
+		if (auto v = dynCast<VarDecl>(d.get())) {
+			if (v->symbol == kNoSymbol) continue;
+			if (module->globalNames.size() <= v->symbol) {
+				module->globalNames.resize(v->symbol + 1);
+				module->globalTypes.resize(v->symbol + 1, Type::ERROR);
+			}
+			module->globalNames[v->symbol] = v->name;
+			module->globalTypes[v->symbol] = v->type;
+		} else if (auto f = dynCast<FunDecl>(d.get())) {
+			if (f->symbol == kNoSymbol) continue;
+			if (module->functionNames.size() <= f->symbol) {
+				module->functionNames.resize(f->symbol + 1);
+			}
+			module->functionNames[f->symbol] = f->name;
+		}
 	}
-	if (auto f = dynamic_cast<const FunDecl*>(&decl)) {
-		genFunDecl(*f);
-		return;
+}
+
+void TACGenerator::nameLocal(SymbolId symbol, const std::string& name, Type type) {
+	if (symbol == kNoSymbol || !isLocalSymbol(symbol)) return;
+	uint32_t i = symbolIndex(symbol);
+	if (fn->localNames.size() <= i) {
+		fn->localNames.resize(i + 1);
+		fn->localTypes.resize(i + 1, Type::ERROR);
+	}
+	fn->localNames[i] = name;
+	fn->localTypes[i] = type;
+}
+
+void TACGenerator::collectLocals(const Stmt& stmt) {
+	switch (stmt.kind) {
+		case NodeKind::CompoundStmt: {
+			const auto& c = static_cast<const CompoundStmt&>(stmt);
+			for (const auto& v : c.localVars) {
+				if (v) nameLocal(v->symbol, v->name, v->type);
+			}
+			for (const auto& s : c.stmts) {
+				if (s) collectLocals(*s);
+			}
+			return;
+		}
+		case NodeKind::IfStmt: {
+			const auto& s = static_cast<const IfStmt&>(stmt);
+			if (s.thenBranch) collectLocals(*s.thenBranch);
+			if (s.elseBranch) collectLocals(*s.elseBranch);
+			return;
+		}
+		case NodeKind::WhileStmt: {
+			const auto& s = static_cast<const WhileStmt&>(stmt);
+			if (s.body) collectLocals(*s.body);
+			return;
+		}
+		case NodeKind::ForStmt: {
+			const auto& s = static_cast<const ForStmt&>(stmt);
+			if (s.body) collectLocals(*s.body);
+			return;
+		}
+		default:
+			return;
+	}
+}
+
+void TACGenerator::genDecl(const Decl& decl) {
+	switch (decl.kind) {
+		case NodeKind::VarDecl:
+			genVarDecl(static_cast<const VarDecl&>(decl));
+			return;
+		case NodeKind::FunDecl:
+			genFunDecl(static_cast<const FunDecl&>(decl));
+			return;
+		default:
+			return;
 	}
 }
 
 void TACGenerator::genVarDecl(const VarDecl& decl) {
-	// ֻʼȫֱʼ
+	// ֻʼȫֱʼڵļͬһԪ
 	if (!decl.init) return;
-	std::string rhs = genExpr(*decl.init);
-	emit(decl.name + " = " + rhs);
+	if (module->functions.empty() || !module->functions.back().name.empty()) {
+		module->functions.emplace_back();
+	}
+	fn = &module->functions.back();
+	TacOperand rhs = genExpr(*decl.init);
+	emit(TacOp::Copy, decl.type, var(decl.symbol, decl.name), rhs);
 }
 
 void TACGenerator::genFunDecl(const FunDecl& decl) {
-	emit("func " + decl.name);
+	module->functions.emplace_back();
+	fn = &module->functions.back();
+	fn->name = decl.name;
+	fn->symbol = decl.symbol;
+	fn->localNames.resize(decl.localCount);
+	fn->localTypes.resize(decl.localCount, Type::ERROR);
+	for (const auto& p : decl.params) {
+		if (!p) continue;
+		nameLocal(p->symbol, p->name, p->type);
+		fn->paramCount++;
+	}
 	if (decl.body) {
+		collectLocals(*decl.body);
 		genCompound(*decl.body);
 	}
-	emit("end func " + decl.name);
-	emit(std::string());
 }
 
 void TACGenerator::genStmt(const Stmt& stmt) {
-	if (auto c = dynamic_cast<const CompoundStmt*>(&stmt)) {
-		genCompound(*c);
-		return;
-	}
-	if (auto i = dynamic_cast<const IfStmt*>(&stmt)) {
-		genIf(*i);
-		return;
-	}
-	if (auto r = dynamic_cast<const ReturnStmt*>(&stmt)) {
-		genReturn(*r);
-		return;
-	}
-	if (auto e = dynamic_cast<const ExprStmt*>(&stmt)) {
-		genExprStmt(*e);
-		return;
-	}
-	if (dynamic_cast<const WhileStmt*>(&stmt)) {
-		emit("# while: not implemented");
-		return;
+	switch (stmt.kind) {
+		case NodeKind::CompoundStmt:
+			genCompound(static_cast<const CompoundStmt&>(stmt));
+			return;
+		case NodeKind::IfStmt:
+			genIf(static_cast<const IfStmt&>(stmt));
+			return;
+		case NodeKind::ReturnStmt:
+			genReturn(static_cast<const ReturnStmt&>(stmt));
+			return;
+		case NodeKind::ExprStmt:
+			genExprStmt(static_cast<const ExprStmt&>(stmt));
+			return;
+		default:
+			// whilefor δʵ֣һռλָ
+			emit(TacOp::Unsupported, Type::VOID, {}, TacOperand::imm(static_cast<uint32_t>(stmt.kind)));
+			return;
 	}
-	if (dynamic_cast<const ForStmt*>(&stmt)) {
-		emit("# for: not implemented");
-		return;
-	}
-
-	emit("# stmt: not implemented");
 }
 
 void TACGenerator::genCompound(const CompoundStmt& stmt) {
@@ -95,8 +187,8 @@ void TACGenerator::genCompound(const CompoundStmt& stmt) {
 	for (const auto& v : stmt.localVars) {
 		if (!v) continue;
 		if (v->init) {
-			std::string rhs = genExpr(*v->init);
-			emit(v->name + " = " + rhs);
+			TacOperand rhs = genExpr(*v->init);
+			emit(TacOp::Copy, v->type, var(v->symbol, v->name), rhs);
 		}
 	}
 	// statements
@@ -107,119 +199,109 @@ void TACGenerator::genCompound(const CompoundStmt& stmt) {
 }
 
 void TACGenerator::genIf(const IfStmt& stmt) {
-	std::string lThen = newLabel();
-	std::string lElse = newLabel();
-	std::string lEnd = newLabel();
+	TacOperand lThen = newLabel();
+	TacOperand lElse = newLabel();
+	TacOperand lEnd = newLabel();
 
-	std::string cond = stmt.cond ? genExpr(*stmt.cond) : "0";
-	emit("if " + cond + " != 0 goto " + lThen);
-	if (stmt.elseBranch) {
-		emit("goto " + lElse);
-	} else {
-		emit("goto " + lEnd);
-	}
+	TacOperand cond = genOptExpr(stmt.cond.get());
+	emit(TacOp::IfGoto, Type::VOID, {}, cond, lThen);
+	emit(TacOp::Goto, Type::VOID, {}, stmt.elseBranch ? lElse : lEnd);
 
 	emitLabel(lThen);
 	if (stmt.thenBranch) {
 		genStmt(*stmt.thenBranch);
 	}
 	if (stmt.elseBranch) {
-		emit("goto " + lEnd);
+		emit(TacOp::Goto, Type::VOID, {}, lEnd);
 		emitLabel(lElse);
 		genStmt(*stmt.elseBranch);
 	}
-	
+
 	emitLabel(lEnd);
 }
 
 void TACGenerator::genReturn(const ReturnStmt& stmt) {
 	if (!stmt.expr) {
-		emit("return");
+		emit(TacOp::Return, Type::VOID, {});
 		return;
 	}
-	std::string v = genExpr(*stmt.expr);
-	emit("return " + v);
+	TacOperand v = genExpr(*stmt.expr);
+	emit(TacOp::Return, stmt.expr->resolvedType, {}, v);
 }
 
 void TACGenerator::genExprStmt(const ExprStmt& stmt) {
 	if (!stmt.expr) return;
-	if (auto call = dynamic_cast<const CallExpr*>(stmt.expr.get())) {
-		genCallExprStmt(*call);
+	if (auto call = dynCast<CallExpr>(stmt.expr.get())) {
+		genCall(*call, false);
 		return;
 	}
 	(void)genExpr(*stmt.expr);
 }
 
-std::string TACGenerator::genExpr(const Expr& expr) {
-	if (auto a = dynamic_cast<const AssignExpr*>(&expr)) return genAssignExpr(*a);
-	if (auto b = dynamic_cast<const BinaryExpr*>(&expr)) return genBinaryExpr(*b);
-	if (auto u = dynamic_cast<const UnaryExpr*>(&expr)) return genUnaryExpr(*u);
-	if (auto c = dynamic_cast<const CallExpr*>(&expr)) return genCallExprValue(*c);
-	if (auto v = dynamic_cast<const ValExpr*>(&expr)) return genValExpr(*v);
-	if (auto i = dynamic_cast<const IntLiteral*>(&expr)) return genIntLiteral(*i);
-	if (auto ch = dynamic_cast<const CharLiteral*>(&expr)) return genCharLiteral(*ch);
-	if (auto d = dynamic_cast<const DoubleLiteral*>(&expr)) return genDoubleLiteral(*d);
-	return "0";
+TacOperand TACGenerator::genExpr(const Expr& expr) {
+	switch (expr.kind) {
+		case NodeKind::AssignExpr: return genAssignExpr(static_cast<const AssignExpr&>(expr));
+		case NodeKind::BinaryExpr: return genBinaryExpr(static_cast<const BinaryExpr&>(expr));
+		case NodeKind::UnaryExpr: return genUnaryExpr(static_cast<const UnaryExpr&>(expr));
+		case NodeKind::CallExpr: return genCall(static_cast<const CallExpr&>(expr), true);
+		case NodeKind::ValExpr: return genValExpr(static_cast<const ValExpr&>(expr));
+		case NodeKind::IntLiteral: return genLiteral(expr, static_cast<const IntLiteral&>(expr).lexeme);
+		case NodeKind::CharLiteral: return genLiteral(expr, static_cast<const CharLiteral&>(expr).lexeme);
+		case NodeKind::DoubleLiteral: return genLiteral(expr, static_cast<const DoubleLiteral&>(expr).lexeme);
+		default: return constant(Type::INT, "0");
+	}
 }
 
-std::string TACGenerator::genAssignExpr(const AssignExpr& expr) {
-	auto lhsVar = dynamic_cast<const ValExpr*>(expr.left.get());
+TacOperand TACGenerator::genOptExpr(const Expr* expr) {
+	return expr ? genExpr(*expr) : constant(Type::INT, "0");
+}
+
+TacOperand TACGenerator::genAssignExpr(const AssignExpr& expr) {
+	auto lhsVar = dynCast<ValExpr>(expr.left.get());
 	if (!lhsVar) {
 		// ׶Ѿƣ
 		throw std::runtime_error("TACGen: assignment lhs must be identifier");
 	}
-	std::string rhs = expr.right ? genExpr(*expr.right) : "0";
-	emit(lhsVar->name + " = " + rhs);
-	return lhsVar->name;
+	TacOperand lhs = var(lhsVar->symbol, lhsVar->name);
+	TacOperand rhs = genOptExpr(expr.right.get());
+	emit(TacOp::Copy, lhsVar->resolvedType, lhs, rhs);
+	return lhs;
 }
 
-std::string TACGenerator::genBinaryExpr(const BinaryExpr& expr) {
-	std::string a = expr.left ? genExpr(*expr.left) : "0";
-	std::string b = expr.right ? genExpr(*expr.right) : "0";
-	std::string t = newTemp();
-	emit(t + " = " + a + " " + expr.op + " " + b);
+TacOperand TACGenerator::genBinaryExpr(const BinaryExpr& expr) {
+	TacOperand a = genOptExpr(expr.left.get());
+	TacOperand b = genOptExpr(expr.right.get());
+	TacOperand t = newTemp();
+	emit(tacOp(expr.op), expr.resolvedType, t, a, b);
 	return t;
 }
 
-std::string TACGenerator::genUnaryExpr(const UnaryExpr& expr) {
-	std::string a = expr.operand ? genExpr(*expr.operand) : "0";
-	std::string t = newTemp();
-	emit(t + " = " + expr.op + " " + a);
+TacOperand TACGenerator::genUnaryExpr(const UnaryExpr& expr) {
+	TacOperand a = genOptExpr(expr.operand.get());
+	TacOperand t = newTemp();
+	emit(tacOp(expr.op), expr.resolvedType, t, a);
 	return t;
 }
 
-void TACGenerator::genCallExprStmt(const CallExpr& expr) {
-	for (const auto& arg : expr.args) {
-		if (!arg) continue;
-		std::string v = genExpr(*arg);
-		emit("param " + v);
+TacOperand TACGenerator::genCall(const CallExpr& expr, bool wantValue) {
+	if (expr.symbol == kNoSymbol) {
+		throw std::runtime_error("TACGen: unresolved function " + expr.name);
 	}
-	emit("call " + expr.name + ", " + std::to_string(expr.args.size()));
-}
-
-std::string TACGenerator::genCallExprValue(const CallExpr& expr) {
 	for (const auto& arg : expr.args) {
 		if (!arg) continue;
-		std::string v = genExpr(*arg);
-		emit("param " + v);
+		TacOperand v = genExpr(*arg);
+		emit(TacOp::Param, arg->resolvedType, {}, v);
 	}
-	std::string t = newTemp();
-	emit(t + " = call " + expr.name + ", " + std::to_string(expr.args.size()));
+	TacOperand t = wantValue ? newTemp() : TacOperand{};
+	emit(TacOp::Call, expr.resolvedType, t, TacOperand::func(expr.symbol),
+		TacOperand::imm(static_cast<uint32_t>(expr.args.size())));
 	return t;
 }
 
-std::string TACGenerator::genValExpr(const ValExpr& expr) {
-	return expr.name;
-}
-
-std::string TACGenerator::genIntLiteral(const IntLiteral& expr) {
-	return expr.lexeme;
-}
-
-std::string TACGenerator::genCharLiteral(const CharLiteral& expr) {
-	return expr.lexeme;
+TacOperand TACGenerator::genValExpr(const ValExpr& expr) {
+	return var(expr.symbol, expr.name);
 }
 
-std::string TACGenerator::genDoubleLiteral(const DoubleLiteral& expr) {
-	return expr.lexeme;
+TacOperand TACGenerator::genLiteral(const Expr& expr, const std::string& lexeme) {
+	return constant(expr.resolvedType, lexeme);
 }
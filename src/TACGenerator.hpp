@@ -1,26 +1,32 @@
 #pragma once
 
 #include "AST.hpp"
+#include "Tac.hpp"
 
-#include <sstream>
 #include <string>
 
 class TACGenerator {
 public:
 	TACGenerator() = default;
 	std::string generate(const Program& program);
+	TacModule build(const Program& program);
 
 private:
-	int tempCounter = 0;
-	int labelCounter = 0;
-	std::ostringstream out;
+	TacModule* module = nullptr;
+	TacFunction* fn = nullptr;
 
-	void reset();
-	std::string newTemp();
-	std::string newLabel();
+	void reset(TacModule& m);
+	TacOperand newTemp();
+	TacOperand newLabel();
+	TacOperand constant(Type type, const std::string& text);
+	TacOperand var(SymbolId symbol, const std::string& name);
 
-	void emit(const std::string& line);
-	void emitLabel(const std::string& label);
+	void emit(TacOp op, Type type, TacOperand dst, TacOperand a = {}, TacOperand b = {});
+	void emitLabel(TacOperand label);
+
+	void declareGlobals(const Program& program);
+	void collectLocals(const Stmt& stmt);
+	void nameLocal(SymbolId symbol, const std::string& name, Type type);
 
 	void genDecl(const Decl& decl);
 	void genVarDecl(const VarDecl& decl);
@@ -32,14 +38,12 @@ private:
 	void genReturn(const ReturnStmt& stmt);
 	void genExprStmt(const ExprStmt& stmt);
 
-	std::string genExpr(const Expr& expr);
-	std::string genAssignExpr(const AssignExpr& expr);
-	std::string genBinaryExpr(const BinaryExpr& expr);
-	std::string genUnaryExpr(const UnaryExpr& expr);
-	std::string genCallExprValue(const CallExpr& expr);
-	void genCallExprStmt(const CallExpr& expr);
-	std::string genValExpr(const ValExpr& expr);
-	std::string genIntLiteral(const IntLiteral& expr);
-	std::string genCharLiteral(const CharLiteral& expr);
-	std::string genDoubleLiteral(const DoubleLiteral& expr);
+	TacOperand genExpr(const Expr& expr);
+	TacOperand genOptExpr(const Expr* expr);
+	TacOperand genAssignExpr(const AssignExpr& expr);
+	TacOperand genBinaryExpr(const BinaryExpr& expr);
+	TacOperand genUnaryExpr(const UnaryExpr& expr);
+	TacOperand genCall(const CallExpr& expr, bool wantValue);
+	TacOperand genValExpr(const ValExpr& expr);
+	TacOperand genLiteral(const Expr& expr, const std::string& lexeme);
 };
@@ -0,0 +1,179 @@
+#include "Tac.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace {
+
+void number(std::string& out, uint32_t v) {
+	char buf[16];
+	auto r = std::to_chars(buf, buf + sizeof(buf), v);
+	out.append(buf, r.ptr);
+}
+
+void operand(const TacModule& m, const TacFunction& fn, const TacOperand& o, std::string& out) {
+	switch (o.kind) {
+		case TacOperand::Kind::None:
+			break;
+		case TacOperand::Kind::Temp:
+			out += 't';
+			number(out, o.id);
+			break;
+		case TacOperand::Kind::Var:
+			out += isLocalSymbol(o.id) ? fn.localNames[symbolIndex(o.id)] : m.globalNames[o.id];
+			break;
+		case TacOperand::Kind::Const:
+			out += fn.consts[o.id].text;
+			break;
+		case TacOperand::Kind::Func:
+			out += m.functionNames[o.id];
+			break;
+		case TacOperand::Kind::Label:
+			out += 'L';
+			number(out, o.id);
+			break;
+		case TacOperand::Kind::Imm:
+			number(out, o.id);
+			break;
+	}
+}
+
+const char* unsupportedName(uint32_t kind) {
+	switch (static_cast<NodeKind>(kind)) {
+		case NodeKind::WhileStmt: return "while";
+		case NodeKind::ForStmt: return "for";
+		default: return "stmt";
+	}
+}
+
+} // namespace
+
+void printTacFunction(const TacModule& m, const TacFunction& fn, std::string& out) {
+	if (!fn.name.empty()) {
+		out += "func ";
+		out += fn.name;
+		out += '\n';
+	}
+	for (const TacInstr& in : fn.code) {
+		if (isBinary(in.op)) {
+			operand(m, fn, in.dst, out);
+			out += " = ";
+			operand(m, fn, in.a, out);
+			out += ' ';
+			out += opSpelling(binaryOp(in.op));
+			out += ' ';
+			operand(m, fn, in.b, out);
+		} else if (isUnary(in.op)) {
+			operand(m, fn, in.dst, out);
+			out += " = ";
+			out += opSpelling(unaryOp(in.op));
+			out += ' ';
+			operand(m, fn, in.a, out);
+		} else {
+			switch (in.op) {
+				case TacOp::Copy:
+					operand(m, fn, in.dst, out);
+					out += " = ";
+					operand(m, fn, in.a, out);
+					break;
+				case TacOp::Param:
+					out += "param ";
+					operand(m, fn, in.a, out);
+					break;
+				case TacOp::Call:
+					if (!in.dst.isNone()) {
+						operand(m, fn, in.dst, out);
+						out += " = ";
+					}
+					out += "call ";
+					operand(m, fn, in.a, out);
+					out += ", ";
+					operand(m, fn, in.b, out);
+					break;
+				case TacOp::Return:
+					out += "return";
+					if (!in.a.isNone()) {
+						out += ' ';
+						operand(m, fn, in.a, out);
+					}
+					break;
+				case TacOp::Label:
+					operand(m, fn, in.a, out);
+					out += ':';
+					break;
+				case TacOp::Goto:
+					out += "goto ";
+					operand(m, fn, in.a, out);
+					break;
+				case TacOp::IfGoto:
+					out += "if ";
+					operand(m, fn, in.a, out);
+					out += " != 0 goto ";
+					operand(m, fn, in.b, out);
+					break;
+				case TacOp::Unsupported:
+					out += "# ";
+					out += unsupportedName(in.a.id);
+					out += ": not implemented";
+					break;
+				default:
+					break;
+			}
+		}
+		out += '\n';
+	}
+	if (!fn.name.empty()) {
+		out += "end func ";
+		out += fn.name;
+		out += "\n\n";
+	}
+}
+
+size_t cleanUpJumps(TacFunction& fn) {
+	std::vector<TacInstr>& code = fn.code;
+	size_t before = code.size();
+	auto target = [](const TacInstr& in) {
+		return in.op == TacOp::Goto ? in.a.id : in.b.id;
+	};
+
+	// a dropped jump or label can put another jump right before its target
+	for (size_t last = code.size() + 1; code.size() < last;) {
+		last = code.size();
+		size_t out = 0;
+		for (size_t i = 0; i < code.size(); ++i) {
+			const TacInstr& in = code[i];
+			if (in.op == TacOp::Goto || in.op == TacOp::IfGoto) {
+				bool next = false;
+				for (size_t j = i + 1; j < code.size() && code[j].op == TacOp::Label && !next; ++j) {
+					next = code[j].a.id == target(in);
+				}
+				// the condition is a plain operand, so nothing is lost with the jump
+				if (next) continue;
+			}
+			code[out++] = in;
+		}
+		code.resize(out);
+
+		std::vector<uint32_t> used;
+		for (const TacInstr& in : code) {
+			if (in.op == TacOp::Goto || in.op == TacOp::IfGoto) used.push_back(target(in));
+		}
+		std::sort(used.begin(), used.end());
+		out = 0;
+		for (size_t i = 0; i < code.size(); ++i) {
+			const TacInstr& in = code[i];
+			if (in.op == TacOp::Label && !std::binary_search(used.begin(), used.end(), in.a.id)) continue;
+			code[out++] = in;
+		}
+		code.resize(out);
+	}
+	return before - code.size();
+}
+
+std::string printTac(const TacModule& m) {
+	std::string out;
+	for (const TacFunction& fn : m.functions) {
+		printTacFunction(m, fn, out);
+	}
+	return out;
+}
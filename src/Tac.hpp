@@ -0,0 +1,123 @@
+#pragma once
+
+#include "AST.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Three-address code as data: one instruction per entry in a function's
+// code vector, operands as small ids, text produced only by printTac.
+
+enum class TacOp : unsigned char {
+	// dst = a op b, in BinaryOp order
+	Add, Sub, Mul, Div, Mod,
+	Lt, Gt, Le, Ge, Eq, Ne,
+	And, Or,
+	// dst = op a, in UnaryOp order
+	Plus, Minus, Deref, Not,
+	Copy,			// dst = a
+	Param,			// param a
+	Call,			// [dst =] call a, b   (a: function, b: argument count)
+	Return,			// return [a]
+	Label,			// a:
+	Goto,			// goto a
+	IfGoto,			// if a != 0 goto b
+	Unsupported,	// a: NodeKind of a statement that is not lowered yet
+};
+
+static_assert(static_cast<unsigned>(TacOp::Or) == static_cast<unsigned>(BinaryOp::Or),
+	"binary opcodes follow BinaryOp");
+static_assert(static_cast<unsigned>(TacOp::Not) - static_cast<unsigned>(TacOp::Plus) ==
+	static_cast<unsigned>(UnaryOp::Not), "unary opcodes follow UnaryOp");
+
+inline TacOp tacOp(BinaryOp op) {
+	return static_cast<TacOp>(op);
+}
+inline TacOp tacOp(UnaryOp op) {
+	return static_cast<TacOp>(static_cast<unsigned>(TacOp::Plus) + static_cast<unsigned>(op));
+}
+inline bool isBinary(TacOp op) {
+	return op <= TacOp::Or;
+}
+inline bool isUnary(TacOp op) {
+	return op >= TacOp::Plus && op <= TacOp::Not;
+}
+inline BinaryOp binaryOp(TacOp op) {
+	return static_cast<BinaryOp>(op);
+}
+inline UnaryOp unaryOp(TacOp op) {
+	return static_cast<UnaryOp>(static_cast<unsigned>(op) - static_cast<unsigned>(TacOp::Plus));
+}
+
+struct TacOperand {
+	enum class Kind : unsigned char {
+		None,
+		Temp,	// id: temp number, printed tN
+		Var,	// id: SymbolId of the variable or parameter
+		Const,	// id: index into the function's consts
+		Func,	// id: SymbolId of the function
+		Label,	// id: label number, printed LN
+		Imm,	// id: the value itself (argument counts, NodeKind)
+	};
+	Kind kind = Kind::None;
+	uint32_t id = 0;
+
+	static TacOperand temp(uint32_t n) { return {Kind::Temp, n}; }
+	static TacOperand var(SymbolId s) { return {Kind::Var, s}; }
+	static TacOperand constant(uint32_t index) { return {Kind::Const, index}; }
+	static TacOperand func(SymbolId s) { return {Kind::Func, s}; }
+	static TacOperand label(uint32_t n) { return {Kind::Label, n}; }
+	static TacOperand imm(uint32_t v) { return {Kind::Imm, v}; }
+
+	bool isNone() const { return kind == Kind::None; }
+	bool operator==(const TacOperand& o) const { return kind == o.kind && id == o.id; }
+	bool operator!=(const TacOperand& o) const { return !(*this == o); }
+};
+
+struct TacInstr {
+	TacOp op = TacOp::Copy;
+	Type type = Type::VOID;		// type of dst (of a for Param and Return)
+	TacOperand dst, a, b;
+};
+
+// A literal as written in the source.
+struct TacConst {
+	Type type = Type::INT;
+	std::string text;
+};
+
+// One function, or a run of global initializers between functions (empty
+// name), which print without the func/end func lines.
+struct TacFunction {
+	std::string name;
+	SymbolId symbol = kNoSymbol;
+	std::vector<TacInstr> code;
+	std::vector<TacConst> consts;
+	std::vector<std::string> localNames;	// by local index of the SymbolId
+	std::vector<Type> localTypes;
+	uint32_t paramCount = 0;	// the parameters are the first locals
+};
+
+struct TacModule {
+	std::vector<TacFunction> functions;		// in source order
+	std::vector<std::string> globalNames;	// by global variable SymbolId
+	std::vector<Type> globalTypes;
+	std::vector<std::string> functionNames;	// by function SymbolId
+	uint32_t tempCount = 0;		// temps are numbered 1..tempCount across the module
+	uint32_t labelCount = 0;	// likewise labels
+
+	Type varType(const TacFunction& fn, SymbolId var) const {
+		return isLocalSymbol(var) ? fn.localTypes[symbolIndex(var)] : globalTypes[var];
+	}
+};
+
+// Drops jumps to a label that directly follows them, then labels no jump
+// refers to, until neither is left. Returns the number of instructions
+// removed.
+size_t cleanUpJumps(TacFunction& fn);
+
+// The text form TACGenerator::generate has always produced.
+std::string printTac(const TacModule& module);
+void printTacFunction(const TacModule& module, const TacFunction& fn, std::string& out);
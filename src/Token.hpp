@@ -1,5 +1,6 @@
 #pragma once
 #include "TokenType.hpp"
+#include <cstdint>
 #include <string>
 #include <iostream>
 
@@ -7,6 +8,7 @@ struct Token{
 	TokenType type;
 	std::string lexeme;
 	int line,column;
+	uint32_t offset=0;	// byte offset in the preprocessed text
 	friend std::ostream&operator<<(std::ostream& os,const Token& token);
 	Token(TokenType tokenType=TokenType::Unknown,int line=0,int column=0,std::string lexeme="");
 	std::string to_string()const;
@@ -30,13 +30,15 @@ std::string TripleGenerator::generate(const Program& program) {
 }
 
 void TripleGenerator::genDecl(const Decl& decl) {
-	if (auto v = dynamic_cast<const VarDecl*>(&decl)) {
-		genVarDecl(*v);
-		return;
-	}
-	if (auto f = dynamic_cast<const FunDecl*>(&decl)) {
-		genFunDecl(*f);
-		return;
+	switch (decl.kind) {
+		case NodeKind::VarDecl:
+			genVarDecl(static_cast<const VarDecl&>(decl));
+			return;
+		case NodeKind::FunDecl:
+			genFunDecl(static_cast<const FunDecl&>(decl));
+			return;
+		default:
+			return;
 	}
 }
 
@@ -57,31 +59,29 @@ void TripleGenerator::genFunDecl(const FunDecl& decl) {
 }
 
 void TripleGenerator::genStmt(const Stmt& stmt) {
-	if (auto c = dynamic_cast<const CompoundStmt*>(&stmt)) {
-		genCompound(*c);
-		return;
-	}
-	if (auto i = dynamic_cast<const IfStmt*>(&stmt)) {
-		genIf(*i);
-		return;
-	}
-	if (auto r = dynamic_cast<const ReturnStmt*>(&stmt)) {
-		genReturn(*r);
-		return;
+	switch (stmt.kind) {
+		case NodeKind::CompoundStmt:
+			genCompound(static_cast<const CompoundStmt&>(stmt));
+			return;
+		case NodeKind::IfStmt:
+			genIf(static_cast<const IfStmt&>(stmt));
+			return;
+		case NodeKind::ReturnStmt:
+			genReturn(static_cast<const ReturnStmt&>(stmt));
+			return;
+		case NodeKind::ExprStmt:
+			genExprStmt(static_cast<const ExprStmt&>(stmt));
+			return;
+		case NodeKind::WhileStmt:
+			emitTriple("note", "while: not implemented", "");
+			return;
+		case NodeKind::ForStmt:
+			emitTriple("note", "for: not implemented", "");
+			return;
+		default:
+			emitTriple("note", "stmt: not implemented", "");
+			return;
 	}
-	if (auto e = dynamic_cast<const ExprStmt*>(&stmt)) {
-		genExprStmt(*e);
-		return;
-	}
-	if (dynamic_cast<const WhileStmt*>(&stmt)) {
-		emitTriple("note", "while: not implemented", "");
-		return;
-	}
-	if (dynamic_cast<const ForStmt*>(&stmt)) {
-		emitTriple("note", "for: not implemented", "");
-		return;
-	}
-	emitTriple("note", "stmt: not implemented", "");
 }
 
 void TripleGenerator::genCompound(const CompoundStmt& stmt) {
@@ -131,7 +131,7 @@ void TripleGenerator::genReturn(const ReturnStmt& stmt) {
 
 void TripleGenerator::genExprStmt(const ExprStmt& stmt) {
 	if (!stmt.expr) return;
-	if (auto call = dynamic_cast<const CallExpr*>(stmt.expr.get())) {
+	if (auto call = dynCast<CallExpr>(stmt.expr.get())) {
 		genCallExprStmt(*call);
 		return;
 	}
@@ -139,19 +139,21 @@ void TripleGenerator::genExprStmt(const ExprStmt& stmt) {
 }
 
 std::string TripleGenerator::genExpr(const Expr& expr) {
-	if (auto a = dynamic_cast<const AssignExpr*>(&expr)) return genAssignExpr(*a);
-	if (auto b = dynamic_cast<const BinaryExpr*>(&expr)) return genBinaryExpr(*b);
-	if (auto u = dynamic_cast<const UnaryExpr*>(&expr)) return genUnaryExpr(*u);
-	if (auto c = dynamic_cast<const CallExpr*>(&expr)) return genCallExprValue(*c);
-	if (auto v = dynamic_cast<const ValExpr*>(&expr)) return genValExpr(*v);
-	if (auto i = dynamic_cast<const IntLiteral*>(&expr)) return genIntLiteral(*i);
-	if (auto ch = dynamic_cast<const CharLiteral*>(&expr)) return genCharLiteral(*ch);
-	if (auto d = dynamic_cast<const DoubleLiteral*>(&expr)) return genDoubleLiteral(*d);
-	return "0";
+	switch (expr.kind) {
+		case NodeKind::AssignExpr: return genAssignExpr(static_cast<const AssignExpr&>(expr));
+		case NodeKind::BinaryExpr: return genBinaryExpr(static_cast<const BinaryExpr&>(expr));
+		case NodeKind::UnaryExpr: return genUnaryExpr(static_cast<const UnaryExpr&>(expr));
+		case NodeKind::CallExpr: return genCallExprValue(static_cast<const CallExpr&>(expr));
+		case NodeKind::ValExpr: return genValExpr(static_cast<const ValExpr&>(expr));
+		case NodeKind::IntLiteral: return genIntLiteral(static_cast<const IntLiteral&>(expr));
+		case NodeKind::CharLiteral: return genCharLiteral(static_cast<const CharLiteral&>(expr));
+		case NodeKind::DoubleLiteral: return genDoubleLiteral(static_cast<const DoubleLiteral&>(expr));
+		default: return "0";
+	}
 }
 
 std::string TripleGenerator::genAssignExpr(const AssignExpr& expr) {
-	auto lhsVar = dynamic_cast<const ValExpr*>(expr.left.get());
+	auto lhsVar = dynCast<ValExpr>(expr.left.get());
 	if (!lhsVar) {
 		throw std::runtime_error("TripleGen: assignment lhs must be identifier");
 	}
@@ -163,13 +165,13 @@ std::string TripleGenerator::genAssignExpr(const AssignExpr& expr) {
 std::string TripleGenerator::genBinaryExpr(const BinaryExpr& expr) {
 	std::string a = expr.left ? genExpr(*expr.left) : "0";
 	std::string b = expr.right ? genExpr(*expr.right) : "0";
-	int idx = emitTriple(expr.op, a, b);
+	int idx = emitTriple(opSpelling(expr.op), a, b);
 	return ref(idx);
 }
 
 std::string TripleGenerator::genUnaryExpr(const UnaryExpr& expr) {
 	std::string a = expr.operand ? genExpr(*expr.operand) : "0";
-	int idx = emitTriple(expr.op, a, "");
+	int idx = emitTriple(opSpelling(expr.op), a, "");
 	return ref(idx);
 }
 
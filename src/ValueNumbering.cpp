@@ -0,0 +1,344 @@
+#include "ValueNumbering.hpp"
+
+#include "Cfg.hpp"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t kNone = ~0u;
+
+struct ExprKey {
+	TacOp op;
+	Type type;
+	uint32_t a, b;
+
+	bool operator==(const ExprKey& o) const {
+		return op == o.op && type == o.type && a == o.a && b == o.b;
+	}
+};
+
+struct ExprKeyHash {
+	size_t operator()(const ExprKey& k) const {
+		uint64_t h = (static_cast<uint64_t>(k.a) << 32 | k.b) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(h ^ (h >> 29) ^ (static_cast<uint64_t>(k.op) << 8 | static_cast<uint64_t>(k.type)));
+	}
+};
+
+// The temp holding a value already computed, and where: outside functions
+// without loops, only the block itself may reuse a value that is not
+// invariant.
+struct Available {
+	uint32_t value;
+	uint32_t temp;
+	uint32_t block;
+};
+
+bool commutes(TacOp op) {
+	return op == TacOp::Add || op == TacOp::Mul || op == TacOp::Eq || op == TacOp::Ne ||
+		op == TacOp::And || op == TacOp::Or;
+}
+
+class Numbering {
+public:
+	explicit Numbering(TacFunction& fn) : fn(fn), code(fn.code) {}
+	size_t run();
+
+private:
+	TacFunction& fn;
+	std::vector<TacInstr>& code;
+	Cfg cfg;
+	bool acyclic = true;
+	bool hasCalls = false;
+
+	// value number -> the same wherever and whenever it is computed
+	std::vector<char> invariant;
+
+	// Temps are defined once, so one number each for the whole function.
+	uint32_t tempBase = 0, tempCount = 0;
+	std::vector<uint32_t> tempValue;
+	std::vector<uint32_t> rename;		// temp -> the earlier temp replacing it
+
+	// Locals: how often they are assigned, where and to what if only once,
+	// and their number in the current block (valid while the stamp matches).
+	std::vector<uint32_t> localDefs, localDefBlock, localDefValue;
+	std::vector<uint32_t> localValue, localStamp;
+	uint32_t blockStamp = 0;
+	// Globals likewise; a call also moves globalStamp on.
+	std::unordered_map<uint32_t, uint32_t> globalDefs, stableGlobal;
+	std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> globalValue;
+	uint32_t globalStamp = 0;
+
+	std::unordered_map<std::string, uint32_t> constValue[5];	// by Type
+
+	// A key entered while numbering a block and what it hid there, if
+	// anything: leaving the dominator subtree erases it or puts that back.
+	struct Entered {
+		ExprKey key;
+		Available shadowed;
+		bool hadEntry;
+	};
+	std::unordered_map<ExprKey, Available, ExprKeyHash> table;
+	std::vector<Entered> entered;
+
+	uint32_t newValue(bool inv) {
+		invariant.push_back(inv);
+		return static_cast<uint32_t>(invariant.size() - 1);
+	}
+	uint32_t tempIndex(uint32_t id) const {
+		uint32_t k = id - tempBase;
+		return k < tempCount ? k : kNone;
+	}
+	void countDefinitions();
+	uint32_t entryValue(uint32_t local, uint32_t block);
+	uint32_t valueOf(const TacOperand& o, uint32_t block);
+	void define(const TacOperand& dst, uint32_t value);
+	void numberBlock(uint32_t b, std::vector<char>& keep);
+};
+
+// An Unsupported placeholder stands for code that may assign anything.
+void Numbering::countDefinitions() {
+	localDefs.assign(fn.localNames.size(), 0);
+	localDefBlock.assign(fn.localNames.size(), kNoBlock);
+	for (uint32_t b = 0; b < cfg.blocks.size(); ++b) {
+		for (uint32_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; ++i) {
+			const TacInstr& in = code[i];
+			if (in.op == TacOp::Unsupported) {
+				for (uint32_t& d : localDefs) d += 2;
+				hasCalls = true;
+				acyclic = false;
+			}
+			hasCalls = hasCalls || in.op == TacOp::Call;
+			if (in.dst.kind != TacOperand::Kind::Var) continue;
+			if (isLocalSymbol(in.dst.id)) {
+				uint32_t l = symbolIndex(in.dst.id);
+				localDefs[l]++;
+				localDefBlock[l] = b;
+			} else {
+				globalDefs[in.dst.id]++;
+			}
+		}
+	}
+	// parameters are assigned on entry
+	for (uint32_t p = 0; p < fn.paramCount; ++p) {
+		localDefs[p]++;
+		localDefBlock[p] = kNoBlock;
+	}
+}
+
+// What a local holds when the block starts.
+uint32_t Numbering::entryValue(uint32_t l, uint32_t block) {
+	bool param = l < fn.paramCount;
+	// never assigned in the body: one number however often it is read
+	if (localDefs[l] == (param ? 1u : 0u)) {
+		if (localDefValue[l] == kNone) localDefValue[l] = newValue(true);
+		return localDefValue[l];
+	}
+	// assigned once, in a block that has finished before this one can start
+	if (acyclic && localDefs[l] == 1 && localDefValue[l] != kNone &&
+		localDefBlock[l] != block && cfg.dominates(localDefBlock[l], block)) {
+		return localDefValue[l];
+	}
+	return newValue(false);
+}
+
+uint32_t Numbering::valueOf(const TacOperand& o, uint32_t block) {
+	switch (o.kind) {
+		case TacOperand::Kind::Const: {
+			const TacConst& c = fn.consts[o.id];
+			auto [it, fresh] = constValue[static_cast<int>(c.type)].try_emplace(c.text, 0);
+			if (fresh) it->second = newValue(true);
+			return it->second;
+		}
+		case TacOperand::Kind::Temp: {
+			uint32_t k = tempIndex(o.id);
+			if (k == kNone) return newValue(false);
+			// read before the definition (not in code TACGenerator writes)
+			if (tempValue[k] == kNone) tempValue[k] = newValue(false);
+			return tempValue[k];
+		}
+		case TacOperand::Kind::Var: {
+			if (isLocalSymbol(o.id)) {
+				uint32_t l = symbolIndex(o.id);
+				if (localStamp[l] != blockStamp) {
+					localStamp[l] = blockStamp;
+					localValue[l] = entryValue(l, block);
+				}
+				return localValue[l];
+			}
+			auto [it, fresh] = globalValue.try_emplace(o.id, 0, kNone);
+			auto& [s, v] = it->second;
+			if (fresh || s != globalStamp) {
+				s = globalStamp;
+				if (!hasCalls && globalDefs.find(o.id) == globalDefs.end()) {
+					auto [st, first] = stableGlobal.try_emplace(o.id, 0);
+					if (first) st->second = newValue(true);
+					v = st->second;
+				} else {
+					v = newValue(false);
+				}
+			}
+			return v;
+		}
+		default:
+			return newValue(false);
+	}
+}
+
+void Numbering::define(const TacOperand& dst, uint32_t value) {
+	if (dst.kind == TacOperand::Kind::Temp) {
+		uint32_t k = tempIndex(dst.id);
+		if (k != kNone) tempValue[k] = value;
+	} else if (dst.kind == TacOperand::Kind::Var) {
+		if (isLocalSymbol(dst.id)) {
+			uint32_t l = symbolIndex(dst.id);
+			localValue[l] = value;
+			localStamp[l] = blockStamp;
+			if (localDefs[l] == 1) localDefValue[l] = value;
+		} else {
+			globalValue[dst.id] = {globalStamp, value};
+		}
+	}
+}
+
+void Numbering::numberBlock(uint32_t b, std::vector<char>& keep) {
+	++blockStamp;
+	++globalStamp;
+	for (uint32_t i = cfg.blocks[b].begin; i < cfg.blocks[b].end; ++i) {
+		TacInstr& in = code[i];
+		bool pure = (isBinary(in.op) || isUnary(in.op)) && in.op != TacOp::Deref;
+		if (pure) {
+			ExprKey key{in.op, in.type, valueOf(in.a, b), isBinary(in.op) ? valueOf(in.b, b) : kNone};
+			if (commutes(key.op) && key.a > key.b) std::swap(key.a, key.b);
+			// a > b is b < a
+			if (key.op == TacOp::Gt || key.op == TacOp::Ge) {
+				key.op = key.op == TacOp::Gt ? TacOp::Lt : TacOp::Le;
+				std::swap(key.a, key.b);
+			}
+			auto it = table.find(key);
+			if (it != table.end() && (acyclic || it->second.block == kNoBlock || it->second.block == b)) {
+				const Available& av = it->second;
+				if (in.dst.kind == TacOperand::Kind::Temp && tempIndex(in.dst.id) != kNone) {
+					rename[tempIndex(in.dst.id)] = av.temp;
+					keep[i] = 0;
+				} else {
+					in.op = TacOp::Copy;
+					in.a = TacOperand::temp(av.temp);
+					in.b = TacOperand();
+				}
+				define(in.dst, av.value);
+				continue;
+			}
+			bool inv = invariant[key.a] && (key.b == kNone || invariant[key.b]);
+			uint32_t v = newValue(inv);
+			if (in.dst.kind == TacOperand::Kind::Temp && tempIndex(in.dst.id) != kNone) {
+				// an entry still here belongs to another block and is unusable in this one
+				Available entry{v, in.dst.id, inv ? kNoBlock : b};
+				auto [slot, fresh] = table.try_emplace(key, entry);
+				entered.push_back(Entered{key, slot->second, !fresh});
+				slot->second = entry;
+			}
+			define(in.dst, v);
+			continue;
+		}
+		switch (in.op) {
+			case TacOp::Copy: {
+				uint32_t v = valueOf(in.a, b);
+				// the variable holds that value already
+				if (in.dst.kind == TacOperand::Kind::Var && valueOf(in.dst, b) == v) {
+					keep[i] = 0;
+					continue;
+				}
+				define(in.dst, v);
+				break;
+			}
+			case TacOp::Call:
+				++globalStamp;
+				if (!in.dst.isNone()) define(in.dst, newValue(false));
+				break;
+			case TacOp::Unsupported:
+				++blockStamp;
+				++globalStamp;
+				break;
+			default:
+				if (!in.dst.isNone()) define(in.dst, newValue(false));
+				break;
+		}
+	}
+}
+
+size_t Numbering::run() {
+	cfg = buildCfg(fn);
+	acyclic = cfg.loops.empty();
+	uint32_t lo = ~0u, hi = 0;
+	for (const TacInstr& in : code) {
+		for (const TacOperand* o : {&in.dst, &in.a, &in.b}) {
+			if (o->kind == TacOperand::Kind::Temp) {
+				lo = std::min(lo, o->id);
+				hi = std::max(hi, o->id);
+			}
+		}
+	}
+	if (lo <= hi) {
+		tempBase = lo;
+		tempCount = hi - lo + 1;
+	}
+	tempValue.assign(tempCount, kNone);
+	rename.assign(tempCount, kNone);
+	localDefValue.assign(fn.localNames.size(), kNone);
+	localValue.assign(fn.localNames.size(), kNone);
+	localStamp.assign(fn.localNames.size(), 0);
+	countDefinitions();
+
+	// blocks in dominator-tree preorder; a block sees what its dominators computed
+	std::vector<char> keep(code.size(), 1);
+	std::vector<std::pair<uint32_t, size_t>> stack;
+	std::vector<size_t> marks;
+	if (!cfg.order.empty()) {
+		stack.emplace_back(0, 0);
+		marks.push_back(0);
+		numberBlock(0, keep);
+	}
+	while (!stack.empty()) {
+		auto& [b, next] = stack.back();
+		const std::vector<uint32_t>& children = cfg.blocks[b].domChildren;
+		if (next < children.size()) {
+			uint32_t c = children[next++];
+			marks.push_back(entered.size());
+			stack.emplace_back(c, 0);
+			numberBlock(c, keep);
+			continue;
+		}
+		for (size_t k = entered.size(); k-- > marks.back();) {
+			if (entered[k].hadEntry) table[entered[k].key] = entered[k].shadowed;
+			else table.erase(entered[k].key);
+		}
+		entered.resize(marks.back());
+		marks.pop_back();
+		stack.pop_back();
+	}
+
+	size_t before = code.size();
+	size_t out = 0;
+	for (size_t i = 0; i < code.size(); ++i) {
+		if (!keep[i]) continue;
+		TacInstr in = code[i];
+		for (TacOperand* o : {&in.a, &in.b}) {
+			if (o->kind != TacOperand::Kind::Temp) continue;
+			uint32_t k = tempIndex(o->id);
+			if (k != kNone && rename[k] != kNone) o->id = rename[k];
+		}
+		code[out++] = in;
+	}
+	code.resize(out);
+	return before - out;
+}
+
+} // namespace
+
+size_t numberValues(TacFunction& fn) {
+	return Numbering(fn).run();
+}
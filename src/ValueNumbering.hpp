@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Tac.hpp"
+
+#include <cstddef>
+
+// Value numbering over one function's TAC: locally within each block and
+// globally along the dominator tree, so an expression computed in a block
+// is reused by every block it dominates.
+//
+// Operands get value numbers; an arithmetic, comparison or logical
+// instruction whose (opcode, type, operand numbers) was seen before in a
+// dominating position is deleted and its temp replaced by the earlier one.
+// Commutative operators and mirrored comparisons share a number, and an
+// assignment of the value a variable already holds is dropped.
+//
+// Variables are mutable, so a block only inherits what is known about them
+// when that cannot have changed on the way: locals never assigned in the
+// function (and globals when there are no calls either), and, in a
+// function without loops, variables assigned exactly once in a dominating
+// block. In a function with loops only expressions over such invariant
+// values are reused across blocks.
+//
+// Returns the number of instructions removed.
+size_t numberValues(TacFunction& fn);
@@ -0,0 +1,322 @@
+// Checks buildCfg's dominators and loops: a few hand-built functions with
+// the answers written out, then random control flow and deep loop nests
+// against a plain reference (iterative dominator sets, natural loops
+// collected per back edge).
+//
+// Build from the repository root (every source file but App.cpp):
+//   g++ -std=c++17 -O2 -pthread -I src tests/cfg/CfgCheck.cpp <src/*.cpp but App.cpp>
+// Run:
+//   CfgCheck [graphs=2000] [seed=1]
+// Exits with 1 if any graph disagrees.
+
+#include "Cfg.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// How a block ends. Every block starts with its own label, so block i of
+// the function is shape i.
+struct Shape {
+	enum Kind { Fall, Jump, Branch, Ret } kind = Fall;
+	uint32_t target = 0;	// Jump and Branch; a Branch also falls through
+};
+
+constexpr uint32_t kLabelBase = 100;
+
+TacFunction makeFunction(const std::vector<Shape>& shapes) {
+	TacFunction fn;
+	fn.name = "f";
+	for (uint32_t i = 0; i < shapes.size(); ++i) {
+		fn.code.push_back(TacInstr{TacOp::Label, Type::VOID, {}, TacOperand::label(kLabelBase + i), {}});
+		fn.code.push_back(TacInstr{TacOp::Copy, Type::INT, TacOperand::temp(1), TacOperand::temp(1), {}});
+		TacOperand target = TacOperand::label(kLabelBase + shapes[i].target);
+		switch (shapes[i].kind) {
+			case Shape::Fall: break;
+			case Shape::Jump: fn.code.push_back(TacInstr{TacOp::Goto, Type::VOID, {}, target, {}}); break;
+			case Shape::Branch:
+				fn.code.push_back(TacInstr{TacOp::IfGoto, Type::VOID, {}, TacOperand::temp(1), target});
+				break;
+			case Shape::Ret: fn.code.push_back(TacInstr{TacOp::Return, Type::VOID, {}, {}, {}}); break;
+		}
+	}
+	return fn;
+}
+
+// What buildCfg should find, worked out the slow way.
+struct Reference {
+	size_t count = 0;
+	std::vector<char> reachable;
+	std::vector<std::vector<char>> dom;	// dom[b][a]: a dominates b
+	std::vector<uint32_t> idom;
+	std::vector<uint32_t> headers;			// blocks with a back edge
+	std::vector<std::vector<char>> body;	// by index into headers
+
+	explicit Reference(const std::vector<Shape>& shapes) : count(shapes.size()) {
+		std::vector<std::vector<uint32_t>> preds(count), succs(count);
+		for (uint32_t b = 0; b < count; ++b) {
+			const Shape& s = shapes[b];
+			if (s.kind == Shape::Jump || s.kind == Shape::Branch) succs[b].push_back(s.target);
+			if ((s.kind == Shape::Fall || s.kind == Shape::Branch) && b + 1 < count) succs[b].push_back(b + 1);
+			for (uint32_t t : succs[b]) preds[t].push_back(b);
+		}
+
+		reachable.assign(count, 0);
+		std::vector<uint32_t> work{0};
+		reachable[0] = 1;
+		while (!work.empty()) {
+			uint32_t b = work.back();
+			work.pop_back();
+			for (uint32_t s : succs[b]) {
+				if (!reachable[s]) {
+					reachable[s] = 1;
+					work.push_back(s);
+				}
+			}
+		}
+
+		dom.assign(count, std::vector<char>(count, 1));
+		dom[0].assign(count, 0);
+		dom[0][0] = 1;
+		for (bool changed = true; changed;) {
+			changed = false;
+			for (uint32_t b = 1; b < count; ++b) {
+				if (!reachable[b]) continue;
+				std::vector<char> next(count, 1);
+				for (uint32_t p : preds[b]) {
+					if (!reachable[p]) continue;
+					for (size_t a = 0; a < count; ++a) next[a] = next[a] && dom[p][a];
+				}
+				next[b] = 1;
+				if (next != dom[b]) {
+					dom[b] = std::move(next);
+					changed = true;
+				}
+			}
+		}
+
+		// the closest strict dominator is the one with the most dominators
+		idom.assign(count, kNoBlock);
+		std::vector<size_t> depth(count, 0);
+		for (uint32_t b = 0; b < count; ++b) {
+			for (uint32_t a = 0; a < count; ++a) depth[b] += reachable[b] && dom[b][a];
+		}
+		idom[0] = 0;
+		for (uint32_t b = 1; b < count; ++b) {
+			if (!reachable[b]) continue;
+			for (uint32_t a = 0; a < count; ++a) {
+				if (a != b && dom[b][a] && (idom[b] == kNoBlock || depth[a] > depth[idom[b]])) idom[b] = a;
+			}
+		}
+
+		for (uint32_t h = 0; h < count; ++h) {
+			if (!reachable[h]) continue;
+			std::vector<char> in(count, 0);
+			in[h] = 1;
+			work.clear();
+			for (uint32_t p : preds[h]) {
+				if (reachable[p] && dom[p][h]) work.push_back(p);
+			}
+			if (work.empty()) continue;
+			while (!work.empty()) {
+				uint32_t b = work.back();
+				work.pop_back();
+				if (in[b]) continue;
+				in[b] = 1;
+				for (uint32_t p : preds[b]) {
+					if (reachable[p]) work.push_back(p);
+				}
+			}
+			headers.push_back(h);
+			body.push_back(std::move(in));
+		}
+	}
+
+	size_t size(size_t loop) const {
+		size_t n = 0;
+		for (char c : body[loop]) n += c;
+		return n;
+	}
+
+	// the smallest loop holding block b, other than skip; headers.size() if none
+	size_t innermost(uint32_t b, size_t skip) const {
+		size_t best = headers.size();
+		for (size_t l = 0; l < headers.size(); ++l) {
+			if (l != skip && body[l][b] && (best == headers.size() || size(l) < size(best))) best = l;
+		}
+		return best;
+	}
+
+	size_t depth(uint32_t b) const {
+		size_t n = 0;
+		for (size_t l = 0; l < headers.size(); ++l) n += body[l][b];
+		return n;
+	}
+};
+
+std::string blockName(uint32_t b) {
+	return b == kNoBlock ? "none" : "B" + std::to_string(b);
+}
+
+// What differs between buildCfg and the reference, or an empty string.
+std::string compare(const std::vector<Shape>& shapes) {
+	Cfg cfg = buildCfg(makeFunction(shapes));
+	Reference ref(shapes);
+	if (cfg.blocks.size() != ref.count) {
+		return std::to_string(cfg.blocks.size()) + " blocks, expected " + std::to_string(ref.count);
+	}
+	for (uint32_t b = 0; b < ref.count; ++b) {
+		if (cfg.reachable(b) != static_cast<bool>(ref.reachable[b])) return blockName(b) + " reachability differs";
+		if (cfg.blocks[b].idom != ref.idom[b]) {
+			return "idom of " + blockName(b) + " is " + blockName(cfg.blocks[b].idom) + ", expected " +
+			       blockName(ref.idom[b]);
+		}
+	}
+	for (uint32_t a = 0; a < ref.count; ++a) {
+		for (uint32_t b = 0; b < ref.count; ++b) {
+			bool expected = ref.reachable[a] && ref.reachable[b] && ref.dom[b][a];
+			if (cfg.dominates(a, b) != expected) {
+				return blockName(a) + (expected ? " should dominate " : " should not dominate ") + blockName(b);
+			}
+		}
+	}
+
+	if (cfg.loops.size() != ref.headers.size()) {
+		return std::to_string(cfg.loops.size()) + " loops, expected " + std::to_string(ref.headers.size());
+	}
+	for (uint32_t b = 0; b < ref.count; ++b) {
+		size_t inner = ref.innermost(b, ref.headers.size());
+		uint32_t got = cfg.blocks[b].loop == kNoLoop ? kNoBlock : cfg.loops[cfg.blocks[b].loop].header;
+		uint32_t expected = inner == ref.headers.size() ? kNoBlock : ref.headers[inner];
+		if (got != expected) {
+			return blockName(b) + " is in the loop at " + blockName(got) + ", expected " + blockName(expected);
+		}
+		if (cfg.loopDepth(b) != ref.depth(b)) {
+			return "loop depth of " + blockName(b) + " is " + std::to_string(cfg.loopDepth(b)) + ", expected " +
+			       std::to_string(ref.depth(b));
+		}
+	}
+	for (const Loop& loop : cfg.loops) {
+		size_t l = 0;
+		while (ref.headers[l] != loop.header) ++l;
+		size_t outer = ref.innermost(loop.header, l);
+		uint32_t expected = outer == ref.headers.size() ? kNoBlock : ref.headers[outer];
+		uint32_t got = loop.parent == kNoLoop ? kNoBlock : cfg.loops[loop.parent].header;
+		if (got != expected) {
+			return "loop at " + blockName(loop.header) + " is inside " + blockName(got) + ", expected " +
+			       blockName(expected);
+		}
+	}
+	return "";
+}
+
+Shape fall() { return Shape{Shape::Fall, 0}; }
+Shape jump(uint32_t t) { return Shape{Shape::Jump, t}; }
+Shape branch(uint32_t t) { return Shape{Shape::Branch, t}; }
+Shape ret() { return Shape{Shape::Ret, 0}; }
+
+int failures = 0;
+
+void expect(bool ok, const char* graph, const std::string& what) {
+	if (ok) return;
+	if (++failures <= 5) std::printf("%s: %s\n", graph, what.c_str());
+}
+
+// Graphs small enough to write the answers down.
+void checkByHand() {
+	{
+		// 0 -> 1 <-> 2, 1 -> 3
+		Cfg cfg = buildCfg(makeFunction({fall(), branch(3), jump(1), ret()}));
+		const char* g = "while loop";
+		expect(cfg.blocks[2].idom == 1 && cfg.blocks[3].idom == 1, g, "idom");
+		expect(cfg.dominates(1, 2) && !cfg.dominates(2, 1) && !cfg.dominates(2, 3), g, "dominates");
+		expect(cfg.loops.size() == 1 && cfg.loops[0].header == 1, g, "one loop headed by B1");
+		expect(cfg.loopDepth(0) == 0 && cfg.loopDepth(1) == 1 && cfg.loopDepth(2) == 1 && cfg.loopDepth(3) == 0, g,
+		       "loop depths");
+	}
+	{
+		// outer loop at 1 (exit 5, latch 4), inner loop at 2 (exit 4, latch 3)
+		Cfg cfg = buildCfg(makeFunction({fall(), branch(5), branch(4), jump(2), jump(1), ret()}));
+		const char* g = "nested loops";
+		expect(cfg.blocks[3].idom == 2 && cfg.blocks[4].idom == 2 && cfg.blocks[5].idom == 1, g, "idom");
+		expect(cfg.dominates(1, 4) && cfg.dominates(2, 3) && !cfg.dominates(3, 4), g, "dominates");
+		expect(cfg.loops.size() == 2, g, "two loops");
+		expect(cfg.loopDepth(3) == 2 && cfg.loopDepth(4) == 1 && cfg.loopDepth(5) == 0, g, "loop depths");
+		uint32_t inner = cfg.blocks[3].loop;
+		expect(inner != kNoLoop && cfg.loops[inner].header == 2 && cfg.loops[inner].parent == cfg.blocks[4].loop, g,
+		       "inner loop inside the outer one");
+	}
+	{
+		// 1 is never reached but jumps into 2; 3 loops on itself out of reach
+		Cfg cfg = buildCfg(makeFunction({jump(2), jump(2), ret(), jump(3)}));
+		const char* g = "unreachable blocks";
+		expect(!cfg.reachable(1) && !cfg.reachable(3), g, "reachability");
+		expect(cfg.blocks[1].idom == kNoBlock && cfg.blocks[2].idom == 0, g, "idom");
+		expect(!cfg.dominates(1, 1) && !cfg.dominates(0, 1) && !cfg.dominates(1, 2), g, "dominates");
+		expect(cfg.loops.empty() && cfg.loopDepth(3) == 0, g, "no loops");
+	}
+	{
+		// 1 and 2 both entered from 0: a cycle with no header
+		Cfg cfg = buildCfg(makeFunction({branch(2), fall(), branch(1), ret()}));
+		const char* g = "irreducible cycle";
+		expect(cfg.blocks[1].idom == 0 && cfg.blocks[2].idom == 0 && cfg.blocks[3].idom == 2, g, "idom");
+		expect(cfg.loops.empty(), g, "no natural loop");
+	}
+}
+
+std::vector<Shape> randomShapes(std::mt19937& rng, uint32_t n) {
+	std::vector<Shape> shapes(n);
+	for (uint32_t i = 0; i < n; ++i) {
+		// mostly short jumps, so loops nest rather than tangle
+		uint32_t near = i >= 8 ? i - 8 + rng() % 16 : rng() % 16;
+		uint32_t target = rng() % 4 == 0 ? rng() % n : std::min(near, n - 1);
+		switch (rng() % 10) {
+			case 0:
+			case 1:
+			case 2: shapes[i] = fall(); break;
+			case 3:
+			case 4: shapes[i] = jump(target); break;
+			case 9: shapes[i] = ret(); break;
+			default: shapes[i] = branch(target); break;
+		}
+	}
+	return shapes;
+}
+
+// depth loops, each header falling into the next one; the deep dominator
+// tree is where path compression matters
+std::vector<Shape> loopNest(uint32_t depth) {
+	std::vector<Shape> shapes{fall()};
+	// header k at block k exits to the block after latch k
+	for (uint32_t k = 1; k <= depth; ++k) shapes.push_back(branch(2 * depth + 3 - k));
+	shapes.push_back(fall());
+	for (uint32_t k = depth; k >= 1; --k) shapes.push_back(jump(k));
+	shapes.push_back(ret());
+	return shapes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int graphs = argc > 1 ? std::atoi(argv[1]) : 2000;
+	std::mt19937 rng(argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1u);
+
+	checkByHand();
+	size_t blocks = 0;
+	for (int i = 0; i < graphs; ++i) {
+		std::vector<Shape> shapes = i % 100 == 99 ? loopNest(1 + rng() % 400) : randomShapes(rng, 1 + rng() % 120);
+		blocks += shapes.size();
+		std::string problem = compare(shapes);
+		if (!problem.empty() && ++failures <= 5) std::printf("graph %d (%zu blocks): %s\n", i, shapes.size(), problem.c_str());
+	}
+	std::vector<Shape> nest = loopNest(300);
+	Cfg cfg = buildCfg(makeFunction(nest));
+	expect(cfg.loopDepth(301) == 300 && cfg.blocks[301].idom == 300, "loop nest", "innermost body at depth 300");
+
+	std::printf("%d graphs (%zu blocks), %d failed\n", graphs, blocks, failures);
+	return failures == 0 ? 0 : 1;
+}
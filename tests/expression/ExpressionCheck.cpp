@@ -0,0 +1,322 @@
+// Differential check of Parser's precedence-climbing expression parser
+// against the per-level recursive descent it replaced, kept here as the
+// reference. Random expressions, valid and broken, go through both; the
+// trees (with node ranges) and the accept/reject decision must agree.
+//
+// Build from the repository root (every source file but App.cpp):
+//   g++ -std=c++17 -O2 -pthread -I src tests/expression/ExpressionCheck.cpp <src/*.cpp but App.cpp>
+// Run:
+//   ExpressionCheck [expressions=20000] [seed=1]
+// Exits with 1 if any expression disagrees.
+
+#include "Lexer.hpp"
+#include "Operator.hpp"
+#include "Parser.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct SyntaxError {};
+
+// The expression grammar as Parser spelled it before precedence climbing:
+// one function per level from assignment down to primary, each looping
+// over its own operators. Renders the tree as nested "(op ...)@begin-end".
+class ReferenceParser {
+public:
+	explicit ReferenceParser(const std::vector<Token>& tokens) : toks(tokens) {}
+
+	// an expression statement "expr ;" followed by "}" and the end of input
+	bool parseStatement(std::string& out) {
+		try {
+			out = parseExpr().text;
+			expect(TokenType::Semicolon);
+			expect(TokenType::RBrace);
+			return check(TokenType::Eof);
+		} catch (const SyntaxError&) {
+			return false;
+		}
+	}
+
+	size_t pos = 0;
+
+private:
+	struct Node {
+		std::string text;
+		uint32_t begin = 0;
+		uint32_t end = 0;
+	};
+
+	const std::vector<Token>& toks;
+	uint32_t lastEnd = 0;
+
+	const Token& cur() const { return toks[pos]; }
+	bool check(TokenType t) const { return cur().type == t; }
+	void advance() {
+		if (check(TokenType::Eof)) return;
+		lastEnd = cur().offset + static_cast<uint32_t>(cur().lexeme.size());
+		++pos;
+	}
+	void expect(TokenType t) {
+		if (!check(t)) throw SyntaxError{};
+		advance();
+	}
+	Node make(const std::string& text, uint32_t begin) const {
+		return Node{text + "@" + std::to_string(begin) + "-" + std::to_string(lastEnd), begin, lastEnd};
+	}
+	Node binary(const Node& left, const char* op, const Node& right) const {
+		return make(std::string("(") + op + " " + left.text + " " + right.text + ")", left.begin);
+	}
+
+	Node parseExpr() { return parseAssignmentExpr(); }
+
+	Node parseAssignmentExpr() {
+		Node left = parseLogicalOrExpr();
+		if (check(TokenType::Assign)) {
+			advance();
+			Node right = parseAssignmentExpr();
+			return binary(left, "=", right);
+		}
+		return left;
+	}
+
+	template<class Next>
+	Node loop(Next next, std::initializer_list<TokenType> ops) {
+		Node left = (this->*next)();
+		for (;;) {
+			bool found = false;
+			for (TokenType t : ops) found = found || check(t);
+			if (!found) return left;
+			BinaryOp op;
+			binaryOpFromToken(cur().type, op);
+			advance();
+			Node right = (this->*next)();
+			left = binary(left, opSpelling(op), right);
+		}
+	}
+
+	Node parseLogicalOrExpr() { return loop(&ReferenceParser::parseLogicalAndExpr, {TokenType::LogicalOr}); }
+	Node parseLogicalAndExpr() { return loop(&ReferenceParser::parseEqualityExpr, {TokenType::LogicalAnd}); }
+	Node parseEqualityExpr() {
+		return loop(&ReferenceParser::parseRelationalExpr, {TokenType::Equal, TokenType::NotEq});
+	}
+	Node parseRelationalExpr() {
+		return loop(&ReferenceParser::parseAdditiveExpr,
+		            {TokenType::Less, TokenType::Greater, TokenType::LessEq, TokenType::GreaterEq});
+	}
+	Node parseAdditiveExpr() {
+		return loop(&ReferenceParser::parseMultiplicativeExpr, {TokenType::Plus, TokenType::Minus});
+	}
+	Node parseMultiplicativeExpr() {
+		return loop(&ReferenceParser::parseUnaryExpr, {TokenType::Star, TokenType::Slash, TokenType::Percent});
+	}
+
+	Node parseUnaryExpr() {
+		UnaryOp op;
+		if (unaryOpFromToken(cur().type, op)) {
+			uint32_t begin = cur().offset;
+			advance();
+			Node operand = parseUnaryExpr();
+			return make(std::string("(") + opSpelling(op) + " " + operand.text + ")", begin);
+		}
+		return parsePrimaryExpr();
+	}
+
+	Node parsePrimaryExpr() {
+		uint32_t begin = cur().offset;
+		if (check(TokenType::IntLiterial) || check(TokenType::CharLiterial) || check(TokenType::DoubleLiterial)) {
+			std::string lexeme = cur().lexeme;
+			advance();
+			return make(lexeme, begin);
+		}
+		if (check(TokenType::Identifier)) {
+			std::string name = cur().lexeme;
+			advance();
+			if (!check(TokenType::LParen)) return make(name, begin);
+			advance();
+			std::string call = "(call " + name;
+			while (!check(TokenType::RParen) && !check(TokenType::Eof)) {
+				call += " " + parseExpr().text;
+				if (!check(TokenType::RParen)) expect(TokenType::Comma);
+			}
+			expect(TokenType::RParen);
+			return make(call + ")", begin);
+		}
+		if (check(TokenType::LParen)) {
+			advance();
+			Node inner = parseExpr();
+			expect(TokenType::RParen);
+			// the range takes in the parentheses, the text stays the inner node's
+			std::string text = inner.text.substr(0, inner.text.rfind('@'));
+			return make(text, begin);
+		}
+		throw SyntaxError{};
+	}
+};
+
+// The same rendering of a tree from Parser.
+std::string render(const Expr* e) {
+	if (!e) return "<null>";
+	std::string text;
+	switch (e->kind) {
+		case NodeKind::AssignExpr: {
+			auto* a = static_cast<const AssignExpr*>(e);
+			text = "(= " + render(a->left.get()) + " " + render(a->right.get()) + ")";
+			break;
+		}
+		case NodeKind::BinaryExpr: {
+			auto* b = static_cast<const BinaryExpr*>(e);
+			text = std::string("(") + opSpelling(b->op) + " " + render(b->left.get()) + " " + render(b->right.get()) + ")";
+			break;
+		}
+		case NodeKind::UnaryExpr: {
+			auto* u = static_cast<const UnaryExpr*>(e);
+			text = std::string("(") + opSpelling(u->op) + " " + render(u->operand.get()) + ")";
+			break;
+		}
+		case NodeKind::CallExpr: {
+			auto* c = static_cast<const CallExpr*>(e);
+			text = "(call " + c->name;
+			for (const auto& arg : c->args) text += " " + render(arg.get());
+			text += ")";
+			break;
+		}
+		case NodeKind::ValExpr: text = static_cast<const ValExpr*>(e)->name; break;
+		case NodeKind::IntLiteral: text = static_cast<const IntLiteral*>(e)->lexeme; break;
+		case NodeKind::CharLiteral: text = static_cast<const CharLiteral*>(e)->lexeme; break;
+		case NodeKind::DoubleLiteral: text = static_cast<const DoubleLiteral*>(e)->lexeme; break;
+		default: text = "<?>"; break;
+	}
+	return text + "@" + std::to_string(e->begin) + "-" + std::to_string(e->end);
+}
+
+class Generator {
+public:
+	explicit Generator(unsigned seed) : rng(seed) {}
+
+	std::vector<std::string> expression() {
+		std::vector<std::string> out;
+		expr(out, 0);
+		return out;
+	}
+
+	// drops, duplicates or inserts a token
+	void breakUp(std::vector<std::string>& toks) {
+		static const char* const extra[] = {"(", ")", "+", "*", "=", ",", "x", "1", "!", "&&", "<"};
+		size_t at = rng() % (toks.size() + 1);
+		switch (rng() % 3) {
+			case 0:
+				if (at < toks.size()) toks.erase(toks.begin() + at);
+				break;
+			case 1:
+				if (at < toks.size()) toks.insert(toks.begin() + at, toks[at]);
+				break;
+			default: toks.insert(toks.begin() + at, extra[rng() % (sizeof(extra) / sizeof(*extra))]); break;
+		}
+	}
+
+	std::string spacing() { return rng() % 3 == 0 ? "" : rng() % 10 == 0 ? "\n" : " "; }
+	unsigned next() { return rng(); }
+
+private:
+	std::mt19937 rng;
+
+	void expr(std::vector<std::string>& out, int depth) {
+		static const char* const binary[] = {"||", "&&", "==", "!=", "<", ">", "<=", ">=", "+", "-", "*", "/", "%"};
+		static const char* const unary[] = {"+", "-", "*", "!"};
+		unsigned pick = depth > 6 ? rng() % 3 : rng() % 10;
+		if (pick < 3) {
+			operand(out, depth);
+		} else if (pick < 7) {
+			expr(out, depth + 1);
+			out.push_back(binary[rng() % 13]);
+			expr(out, depth + 1);
+		} else if (pick < 8) {
+			out.push_back(unary[rng() % 4]);
+			expr(out, depth + 1);
+		} else if (pick < 9) {
+			out.push_back("(");
+			expr(out, depth + 1);
+			out.push_back(")");
+		} else {
+			operand(out, depth);
+			out.push_back("=");
+			expr(out, depth + 1);
+		}
+	}
+
+	void operand(std::vector<std::string>& out, int depth) {
+		static const char* const names[] = {"a", "b", "x1", "value"};
+		static const char* const literals[] = {"0", "42", "3.5", "'c'"};
+		switch (rng() % 5) {
+			case 0:
+			case 1: out.push_back(names[rng() % 4]); break;
+			case 2:
+			case 3: out.push_back(literals[rng() % 4]); break;
+			default: {
+				out.push_back("f");
+				out.push_back("(");
+				unsigned args = depth > 6 ? 0 : rng() % 3;
+				for (unsigned i = 0; i < args; ++i) {
+					if (i > 0) out.push_back(",");
+					expr(out, depth + 1);
+				}
+				out.push_back(")");
+				break;
+			}
+		}
+	}
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int count = argc > 1 ? std::atoi(argv[1]) : 20000;
+	Generator gen(argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1u);
+
+	int failures = 0;
+	int accepted = 0;
+	for (int i = 0; i < count; ++i) {
+		std::vector<std::string> parts = gen.expression();
+		if (i % 3 == 2) gen.breakUp(parts);
+		std::string text = "int main(){";
+		for (const std::string& p : parts) text += gen.spacing() + p;
+		text += gen.spacing() + ";}";
+
+		Lexer lexer;
+		lexer.setText(text);
+		lexer.doLexer();
+		std::vector<Token> tokens = lexer.getTokens();
+
+		// "int main ( ) {" comes before the expression
+		ReferenceParser reference(tokens);
+		reference.pos = 5;
+		std::string expected;
+		bool referenceOk = reference.parseStatement(expected);
+
+		Parser parser;
+		parser.setTokens(tokens);
+		ProgramPtr prog = parser.parse();
+		bool parserOk = !parser.hasErrors();
+		std::string got;
+		if (parserOk) {
+			auto* fun = static_cast<const FunDecl*>(prog->decls[0].get());
+			auto* stmt = static_cast<const ExprStmt*>(fun->body->stmts[0].get());
+			got = render(stmt->expr.get());
+		}
+
+		accepted += referenceOk;
+		if (referenceOk != parserOk || (parserOk && got != expected)) {
+			if (++failures <= 5) {
+				std::printf("%s\n  reference: %s\n  parser:    %s\n", text.c_str(),
+				            referenceOk ? expected.c_str() : "<syntax error>", parserOk ? got.c_str() : "<syntax error>");
+			}
+		}
+	}
+	std::printf("%d expressions (%d valid), %d differ\n", count, accepted, failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+// Checks IncrementalParser and SemanticAnalyzer::reanalyze against a full
+// lex, parse and analysis of the edited text after every step of a random
+// edit sequence, and reports the average time per edit and re-analysis.
+//
+// Build from the repository root (every source file but App.cpp):
+//   g++ -std=c++17 -O2 -pthread -I src tests/incremental/IncrementalCheck.cpp <src/*.cpp but App.cpp>
+// Run:
+//   IncrementalCheck [edits=2000] [seed=1] [functions=200 | source file]
+// Exits with 1 if any step disagrees.
+
+#include "IncrementalParser.hpp"
+#include "Lexer.hpp"
+#include "Parser.hpp"
+#include "SemanticAnalyzer.hpp"
+#include "TACGenerator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A program with globals, calls between functions and every statement kind.
+std::string makeProgram(int functions) {
+	std::string s;
+	for (int i = 0; i < functions; ++i) {
+		std::string n = std::to_string(i);
+		s += "int g" + n + " = " + n + ";\n";
+		s += "double h" + n + ";\n";
+		s += "int f" + n + "(int a, double b)\n{\n";
+		s += "    int x;\n    x = a + g" + n + " * 2;\n";
+		s += "    if (x > 3 && b < 1.5) {\n        x = x - 1;\n    } else {\n        h" + n + " = b;\n    }\n";
+		s += "    while (x < 10) x = x + 1;\n";
+		s += "    for (x = 0; x < a; x = x + 1) { g" + n + " = -x; }\n";
+		if (i > 0) s += "    x = f" + std::to_string(i - 1) + "(x, 'c');\n";
+		s += "    return (x + 1) * 2;\n}\n\n";
+	}
+	s += "int main()\n{\n    return f" + std::to_string(functions > 0 ? functions - 1 : 0) + "(1, 2.0);\n}\n";
+	return s;
+}
+
+struct Lexed {
+	std::vector<Token> tokens;
+	LineMap lines;
+};
+
+Lexed lex(const std::string& text) {
+	Lexer lexer;
+	lexer.setText(text);
+	lexer.doLexer();
+	return Lexed{lexer.getTokens(), lexer.getLineMap()};
+}
+
+std::unique_ptr<IncrementalParser> startFrom(const std::string& text) {
+	Lexed l = lex(text);
+	Parser parser;
+	parser.setTokens(l.tokens);
+	return std::make_unique<IncrementalParser>(parser.parse(), l.tokens, l.lines);
+}
+
+void collectRanges(const ASTNode* n, std::vector<uint32_t>& out);
+
+template<class T>
+void collectList(const NodeList<T>& list, std::vector<uint32_t>& out) {
+	for (const auto& n : list) collectRanges(n.get(), out);
+}
+
+// begin/end of every node in pre-order; ~0 marks a missing child
+void collectRanges(const ASTNode* n, std::vector<uint32_t>& out) {
+	if (!n) {
+		out.push_back(~0u);
+		return;
+	}
+	out.push_back(n->begin);
+	out.push_back(n->end);
+	switch (n->kind) {
+		case NodeKind::Program: collectList(static_cast<const Program*>(n)->decls, out); break;
+		case NodeKind::VarDecl: collectRanges(static_cast<const VarDecl*>(n)->init.get(), out); break;
+		case NodeKind::FunDecl: {
+			auto* f = static_cast<const FunDecl*>(n);
+			collectList(f->params, out);
+			collectRanges(f->body.get(), out);
+			break;
+		}
+		case NodeKind::CompoundStmt: {
+			auto* c = static_cast<const CompoundStmt*>(n);
+			collectList(c->localVars, out);
+			collectList(c->stmts, out);
+			break;
+		}
+		case NodeKind::IfStmt: {
+			auto* s = static_cast<const IfStmt*>(n);
+			collectRanges(s->cond.get(), out);
+			collectRanges(s->thenBranch.get(), out);
+			collectRanges(s->elseBranch.get(), out);
+			break;
+		}
+		case NodeKind::WhileStmt: {
+			auto* s = static_cast<const WhileStmt*>(n);
+			collectRanges(s->cond.get(), out);
+			collectRanges(s->body.get(), out);
+			break;
+		}
+		case NodeKind::ForStmt: {
+			auto* s = static_cast<const ForStmt*>(n);
+			collectRanges(s->init.get(), out);
+			collectRanges(s->cond.get(), out);
+			collectRanges(s->update.get(), out);
+			collectRanges(s->body.get(), out);
+			break;
+		}
+		case NodeKind::ReturnStmt: collectRanges(static_cast<const ReturnStmt*>(n)->expr.get(), out); break;
+		case NodeKind::ExprStmt: collectRanges(static_cast<const ExprStmt*>(n)->expr.get(), out); break;
+		case NodeKind::AssignExpr: {
+			auto* e = static_cast<const AssignExpr*>(n);
+			collectRanges(e->left.get(), out);
+			collectRanges(e->right.get(), out);
+			break;
+		}
+		case NodeKind::BinaryExpr: {
+			auto* e = static_cast<const BinaryExpr*>(n);
+			collectRanges(e->left.get(), out);
+			collectRanges(e->right.get(), out);
+			break;
+		}
+		case NodeKind::UnaryExpr: collectRanges(static_cast<const UnaryExpr*>(n)->operand.get(), out); break;
+		case NodeKind::CallExpr: collectList(static_cast<const CallExpr*>(n)->args, out); break;
+		default: break;
+	}
+}
+
+bool sameToken(const Token& a, const Token& b) {
+	return a.type == b.type && a.lexeme == b.lexeme && a.line == b.line && a.column == b.column &&
+	       a.offset == b.offset;
+}
+
+std::vector<std::string> messages(const SemanticAnalyzer& sema, const LineMap& lines) {
+	std::vector<std::string> out;
+	for (const Diagnostic& d : sema.diagnostics().diagnostics()) out.push_back(DiagnosticSink::format(d, &lines));
+	return out;
+}
+
+std::string tacOf(const Program& prog) {
+	try {
+		TACGenerator gen;
+		return gen.generate(prog);
+	} catch (const std::exception& e) {
+		return std::string("error: ") + e.what();
+	}
+}
+
+// Global variables and functions, each numbered from 0.
+struct DeclCounts {
+	size_t variables = 0;
+	size_t functions = 0;
+};
+
+DeclCounts countDecls(const Program& prog) {
+	DeclCounts n;
+	for (const auto& decl : prog.decls) {
+		n.variables += dynCast<VarDecl>(decl.get()) != nullptr;
+		n.functions += dynCast<FunDecl>(decl.get()) != nullptr;
+	}
+	return n;
+}
+
+// What differs between the incremental state and a full parse and analysis
+// of text, or an empty string. reanalyze() reuses the ids of removed
+// declarations, so none may reach the most declarations of its kind so far.
+std::string compare(IncrementalParser& ip, const SemanticAnalyzer& sema, const std::string& text,
+                    const DeclCounts& peak) {
+	Lexed ref = lex(text);
+	std::vector<Token> toks = ip.tokens();
+	if (toks.size() != ref.tokens.size()) {
+		return "token count " + std::to_string(toks.size()) + ", expected " + std::to_string(ref.tokens.size());
+	}
+	for (size_t i = 0; i < toks.size(); ++i) {
+		if (!sameToken(toks[i], ref.tokens[i])) {
+			return "token " + std::to_string(i) + " is " + toks[i].to_string() + ", expected " +
+			       ref.tokens[i].to_string();
+		}
+	}
+	LineMap lines = ip.lineMap();
+	bool sameLines = lines.lineCount() == ref.lines.lineCount();
+	for (size_t i = 0; sameLines && i < lines.lineCount(); ++i) sameLines = lines.lineStart(i) == ref.lines.lineStart(i);
+	if (!sameLines) return "line map differs";
+
+	Parser parser;
+	parser.setTokens(ref.tokens);
+	ProgramPtr full = parser.parse();
+	if (parser.hasErrors()) return "";
+	const Program& prog = ip.program();
+	if (dumpAstToString(prog) != dumpAstToString(*full)) return "AST differs";
+	std::vector<uint32_t> got, expected;
+	collectRanges(&prog, got);
+	collectRanges(full.get(), expected);
+	if (got != expected) return "node ranges differ";
+	for (const auto& decl : prog.decls) {
+		auto var = dynCast<VarDecl>(decl.get());
+		auto fun = dynCast<FunDecl>(decl.get());
+		SymbolId id = var ? var->symbol : fun ? fun->symbol : kNoSymbol;
+		size_t limit = var ? peak.variables : peak.functions;
+		if (id != kNoSymbol && id >= limit) {
+			return "symbol id " + std::to_string(id) + " with at most " + std::to_string(limit) + " declarations";
+		}
+	}
+
+	// the names and calls reanalyze() left annotated must lower the same way
+	SemanticAnalyzer fresh;
+	fresh.analyze(*full);
+	if (messages(sema, lines) != messages(fresh, ref.lines)) return "semantic diagnostics differ";
+	if (!fresh.hasErrors() && tacOf(prog) != tacOf(*full)) return "TAC differs";
+	return "";
+}
+
+int lineOf(const std::string& text, size_t offset, int& column) {
+	int line = 1;
+	size_t lineStart = 0;
+	for (size_t i = 0; i < offset; ++i) {
+		if (text[i] == '\n') {
+			++line;
+			lineStart = i + 1;
+		}
+	}
+	column = static_cast<int>(offset - lineStart + 1);
+	return line;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int edits = argc > 1 ? std::atoi(argv[1]) : 2000;
+	std::mt19937 rng(argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1u);
+	std::string text;
+	if (argc > 3 && std::atoi(argv[3]) == 0) {
+		std::ifstream in(argv[3]);
+		std::stringstream ss;
+		ss << in.rdbuf();
+		// what the Preprocessor hands the lexer
+		for (char c : ss.str()) {
+			if (c != '\r') text += c == '\t' ? ' ' : c;
+		}
+	} else {
+		text = makeProgram(argc > 3 ? std::atoi(argv[3]) : 200);
+	}
+
+	static const char* const snippets[] = {
+		"x", "1", "+", "(", ")", "{", "}", ";", " ", "\n", "*", "=",
+		"y = y + 1;", "int q;\n", "if (a) { b = 1; }", "int zz(int a){ return a; }\n",
+	};
+	static const char* const statements[] = {" x = x + 1;", " x = (x * 2) - a;", " if (x) { x = 3; }"};
+
+	auto ip = startFrom(text);
+	SemanticAnalyzer sema;
+	sema.analyze(ip->program());
+	double total = 0;
+	double analysis = 0;
+	int failures = 0;
+	int validSteps = 0;
+	DeclCounts peak = countDecls(ip->program());
+	// Edits since the text last parsed, each as the edit that takes it
+	// back; broken text is usually repaired by undoing them in turn.
+	struct Undo {
+		size_t at;
+		size_t length;
+		std::string text;
+	};
+	std::vector<Undo> undos;
+	for (int step = 0; step < edits; ++step) {
+		size_t a = rng() % (text.size() + 1);
+		size_t b = std::min(text.size(), a + (rng() % 4 == 0 ? rng() % 40 : rng() % 3));
+		std::string newText = rng() % 3 == 0 ? "" : snippets[rng() % (sizeof(snippets) / sizeof(*snippets))];
+		bool undo = !undos.empty() && rng() % 3 != 0;
+		if (undo) {
+			a = undos.back().at;
+			b = a + undos.back().length;
+			newText = undos.back().text;
+			undos.pop_back();
+		} else if (step % 2 == 1) {
+			// an edit that keeps the program valid: a statement after one in
+			// a body, or a function after a top-level '}'
+			bool function = rng() % 4 == 0;
+			const char* after = function ? "}\n\n" : ";\n ";
+			size_t at = text.find(after, rng() % text.size());
+			if (at == std::string::npos) at = text.find(after);
+			if (at != std::string::npos) {
+				a = b = at + 1;
+				newText = text[at] == '}' ? "\nint n(int a){ return a; }\n" : statements[rng() % 3];
+			}
+		}
+		if (!undo) undos.push_back(Undo{a, newText.size(), text.substr(a, b - a)});
+		TextEdit edit;
+		edit.beginLine = lineOf(text, a, edit.beginColumn);
+		edit.endLine = lineOf(text, b, edit.endColumn);
+		edit.newText = newText;
+		text = text.substr(0, a) + newText + text.substr(b);
+
+		auto t0 = std::chrono::steady_clock::now();
+		ReparseResult r = ip->applyEdit(edit);
+		auto t1 = std::chrono::steady_clock::now();
+		const Program& prog = ip->program();
+		auto t2 = std::chrono::steady_clock::now();
+		sema.reanalyze(prog, r.firstDecl, r.removedDecls, r.insertedDecls);
+		auto t3 = std::chrono::steady_clock::now();
+		total += std::chrono::duration<double, std::micro>(t1 - t0).count();
+		analysis += std::chrono::duration<double, std::micro>(t3 - t2).count();
+
+		DeclCounts now = countDecls(prog);
+		peak.variables = std::max(peak.variables, now.variables);
+		peak.functions = std::max(peak.functions, now.functions);
+		std::string problem = compare(*ip, sema, text, peak);
+		if (!problem.empty()) {
+			if (++failures <= 5) {
+				std::printf("step %d: edit %d:%d-%d:%d \"%s\": %s\n", step, edit.beginLine, edit.beginColumn,
+				            edit.endLine, edit.endColumn, newText.c_str(), problem.c_str());
+			}
+			// carry on from a fresh parse
+			ip = startFrom(text);
+			sema.analyze(ip->program());
+		}
+		Parser parser;
+		parser.setTokens(lex(text).tokens);
+		parser.parse();
+		if (!parser.hasErrors()) {
+			undos.clear();
+			++validSteps;
+		}
+	}
+	std::printf("%d edits (%d on valid text), %d failed, %.1f us per edit, %.1f us per re-analysis\n", edits,
+	            validSteps, failures, edits > 0 ? total / edits : 0.0, edits > 0 ? analysis / edits : 0.0);
+	return failures == 0 ? 0 : 1;
+}
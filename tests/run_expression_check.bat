@@ -0,0 +1,28 @@
+@echo off
+REM tests\run_expression_check.bat  벢бʽ﷨Ķռ飨ԭݹ½дȽϣ
+REM ʹ÷ʽ cmd бűԭ[ʽ] []
+
+SETLOCAL ENABLEDELAYEDEXPANSION
+
+SET "SCRIPT_DIR=%~dp0"
+SET "SRC_DIR=%SCRIPT_DIR%..\src"
+SET "EXE=%SCRIPT_DIR%expression\ExpressionCheck.exe"
+
+REM  App.cpp mainȫԴļ
+SET "SOURCES="
+FOR %%F IN ("%SRC_DIR%\*.cpp") DO (
+    IF /I NOT "%%~nxF"=="App.cpp" SET SOURCES=!SOURCES! "%%F"
+)
+
+g++ -std=c++17 -O2 -pthread -I "%SRC_DIR%" "%SCRIPT_DIR%expression\ExpressionCheck.cpp" !SOURCES! -o "%EXE%"
+IF ERRORLEVEL 1 (
+    echo ʧ
+    exit /b 1
+)
+
+"%EXE%" %*
+IF ERRORLEVEL 1 (
+    echo ʽ﷨ʵֲһ
+    exit /b 1
+)
+ENDLOCAL
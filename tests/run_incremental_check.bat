@@ -0,0 +1,28 @@
+@echo off
+REM tests\run_incremental_check.bat  벢﷨Ķռ
+REM ʹ÷ʽ cmd бűԭ[༭] [] [Դļ]
+
+SETLOCAL ENABLEDELAYEDEXPANSION
+
+SET "SCRIPT_DIR=%~dp0"
+SET "SRC_DIR=%SCRIPT_DIR%..\src"
+SET "EXE=%SCRIPT_DIR%incremental\IncrementalCheck.exe"
+
+REM  App.cpp mainȫԴļ
+SET "SOURCES="
+FOR %%F IN ("%SRC_DIR%\*.cpp") DO (
+    IF /I NOT "%%~nxF"=="App.cpp" SET SOURCES=!SOURCES! "%%F"
+)
+
+g++ -std=c++17 -O2 -pthread -I "%SRC_DIR%" "%SCRIPT_DIR%incremental\IncrementalCheck.cpp" !SOURCES! -o "%EXE%"
+IF ERRORLEVEL 1 (
+    echo ʧ
+    exit /b 1
+)
+
+"%EXE%" %*
+IF ERRORLEVEL 1 (
+    echo һ
+    exit /b 1
+)
+ENDLOCAL
@@ -1,5 +1,5 @@
 @echo off
-REM tests\run_tests.bat   input е .txt output
+REM tests\run_tests.bat   input е .txt output -O  .O.out -j 4 ɵĴļ
 REM ʹ÷ʽ˫ cmd бű
 
 SETLOCAL ENABLEDELAYEDEXPANSION
@@ -39,8 +39,28 @@ FOR /F "delims=" %%F IN ('dir /b /on "%INPUT_DIR%\*.txt"') DO (
         echo ֹͣڣ%%F
         exit /b 1
     )
+    REM  -O һΣŻַ
+    "%EXE%" -O -i "!infile!" -o "%OUTPUT_DIR%\!name!.O.out"
+    IF ERRORLEVEL 1 (
+        echo Żʱֹͣڣ%%F
+        exit /b 1
+    )
     SET /A idx+=1
 )
 
+REM ɺ3000ĴļLL(1)չʾޣ -j 4 н
+SET "LARGE=%OUTPUT_DIR%\large.txt"
+echo [!idx!] ɲ -j 4  %LARGE%
+(
+    FOR /L %%I IN (1,1,3000) DO echo int f%%I^(int a^){ int b; b = a * %%I + 1; return b; }
+    echo int main^(^){ return f1^(2^); }
+) > "%LARGE%"
+"%EXE%" -j 4 -i "%LARGE%" -o "%OUTPUT_DIR%\large.out"
+findstr /C:"ɹ" "%OUTPUT_DIR%\large.out" >NUL
+IF ERRORLEVEL 1 (
+    echo ļнʧܣ %OUTPUT_DIR%\large.out
+    exit /b 1
+)
+
 echo ȫɡ
 ENDLOCAL